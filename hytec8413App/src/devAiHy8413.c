@@ -6,8 +6,12 @@
   Name: devAiHy8413.c
          *   init_ai            - initialization
          *   read_ai            - read analog input
+         *   read_ai_ave        - read software filter output
+         *   init_ai_egu        - initialization, direct EGU conversion
+         *   read_ai_egu        - read analog input in EGU
          *   get_ioint_info_ai  - Get I/O event list info
          *   special_linconv_ai - linear conversion routine
+         *   special_linconv_ai_egu - EGU coefficients update
 
   Proto: None
 
@@ -18,6 +22,12 @@
   Mod:
         08-Nov-2006, K. Luchini       (LUCHINI):
           cast arg 1 in hy8413_rd() to void ptr
+        17-Oct-2026, agent            (AGENT):
+          read the channel from the card snapshot, see drvHy8413Snap.c
+          add devAiHy8413Ave for the software filters, see drvHy8413Filt.c
+          calibrate with drvHy8413_cal_val(), which uses the tables if built
+          read the channel calibrated once per snapshot by the driver
+          add devAiHy8413Egu, calibration and EGU scale folded per channel
 
 =============================================================
 */
@@ -44,13 +54,17 @@
 #include "hytecIpm.h"       /* for IPADC_ID,DPVT_ID     */
 #include "hytecIpmLib.h"    /* for hytec_ipmInitDev()   */
 #include "drvHy8413.h"      /* for factor_5pt, etc      */
-#include "drvHy8413Lib.h"   /* for drvHy8413_rd() proto */
+#include "drvHy8413Lib.h"   /* for drvHy8413_snap_rd()  */
 #include "epicsExport.h"
 
 
 /* Local prototypes */
 static long init_ai( void *rec_p );
 static long read_ai( void *rec_p );
+static long read_ai_ave( void *rec_p );
+static long init_ai_egu( void *rec_p );
+static long read_ai_egu( void *rec_p );
+static long special_linconv_ai_egu( void *rec_p, int after );
 static long get_ioint_info_ai( int cmd, void *rec_p,IOSCANPVT *evt_pp );
 static long special_linconv_ai(void *rec_p,int after);
 
@@ -82,6 +96,46 @@ struct {
 
 epicsExportAddress(dset,devAiHy8413);
 
+/* Software filter output, same INP as devAiHy8413 */
+struct {
+     long       number;
+     DEVSUPFUN  report;
+     DEVSUPFUN  init;
+     DEVSUPFUN  init_record;
+     DEVSUPFUN  get_ioint_info;
+     DEVSUPFUN  read_write;
+     DEVSUPFUN  special_linconv;
+} devAiHy8413Ave = {
+        6,
+        NULL,
+        NULL,
+        init_ai,
+        get_ioint_info_ai,
+        read_ai_ave,
+        special_linconv_ai };
+
+epicsExportAddress(dset,devAiHy8413Ave);
+
+/* Raw value to EGU in one step, same INP as devAiHy8413 */
+struct {
+     long       number;
+     DEVSUPFUN  report;
+     DEVSUPFUN  init;
+     DEVSUPFUN  init_record;
+     DEVSUPFUN  get_ioint_info;
+     DEVSUPFUN  read_write;
+     DEVSUPFUN  special_linconv;
+} devAiHy8413Egu = {
+        6,
+        NULL,
+        NULL,
+        init_ai_egu,
+        get_ioint_info_ai,
+        read_ai_egu,
+        special_linconv_ai_egu };
+
+epicsExportAddress(dset,devAiHy8413Egu);
+
 
 /*=============================================================
 
@@ -212,8 +266,12 @@ static long get_ioint_info_ai( int cmd, void *rec_p, IOSCANPVT *evt_pp )
           Mech: By reference
 
   Rem: This routine processes a analog input record.
-       The floating point read from the specified hardware
-       memeory location, and stored into the VAL field.
+       The channel is read from the snapshot of the card,
+       so records processed together see the same conversion
+       cycle, and stored into the VAL field. The snapshot
+       channels are already calibrated when calibration is
+       enabled for the channel. With TSE=-2 the
+       record time is the time of the snapshot.
 
   Side: Conversion from a raw value to engineering units
         will not be performed if the field "LINR" is zero.
@@ -230,15 +288,13 @@ static long read_ai(void *rec_p)
 {
    long                 status=OK;          /* status return            */
    unsigned short       rval=0;             /* raw data value           */
-   unsigned short       rescale=0;          /* use channel calibration  */
-   unsigned short       i=0;                  /* channel number           */
    unsigned short       cur_stat   = READ_ALARM;      /* alarm status   */
    unsigned short       cur_sevr   = INVALID_ALARM;   /* alarm severity */
    DPVT_ID              devPvt_ps  = NULL;
    IPADC_ID             card_ps    = NULL;
-   hytec_ipmCalChan_ts *cal_ps = NULL;
    struct aiRecord     *rec_ps      = (struct aiRecord *)rec_p;
    char                *taskName_c = "devAiHy8413( read )";
+   epicsTimeStamp      *time_p     = NULL;            /* snapshot time  */
 
 
    /*
@@ -261,21 +317,17 @@ static long read_ai(void *rec_p)
    */
    devPvt_ps = (DPVT_ID)rec_ps->dpvt;
    card_ps   = devPvt_ps->card_ps;
-   status    = drvHy8413_rd(card_ps->io_p,devPvt_ps->i,(short *)&rval);
+#ifdef epicsTimeEventDeviceTime
+   if ( rec_ps->tse == epicsTimeEventDeviceTime ) time_p = &rec_ps->time;
+#endif
+   status    = drvHy8413_snap_rd( card_ps,
+                                  devPvt_ps->i,
+                                  1,
+                                  &devPvt_ps->gen,
+                                  (short *)&rval,
+                                  time_p );
    if (status==OK)
    {
-       i       = devPvt_ps->i;
-       cal_ps  = &card_ps->cal_s.chan_as[i];
-       rescale = cal_ps->enb;
-       if ( rescale && card_ps->cal_s.enb && cal_ps->init )
-       {
-          rval = drvHy8413_cal_adc( &cal_ps->gain_a[card_ps->format][0],
-                                    card_ps->cal_s.type,
-                                    card_ps->format,
-                                    rval );
-   
-       }
-
        if ( !rec_ps->linr )
        {
          rec_ps->val  = rval;
@@ -289,6 +341,180 @@ static long read_ai(void *rec_p)
    return(status);
 }
 
+/*=============================================================
+
+  Abs:  Input device support read of a software filter
+
+  Name: read_ai_ave
+
+  Args: rec_p                      Record information
+          Use:  struct
+          Type: void *
+          Acc:  read-write access
+          Mech: By reference
+
+  Rem: This routine processes an analog input record reading
+       the software filter output of a channel. The output has
+       HY8413_FILT_FRAC fraction bits. As read_ai does, with no
+       conversion (LINR=NO CONVERSION) VAL is set directly, here
+       with the fraction kept. Otherwise RVAL is set to the
+       output rounded to a count and the record converts it,
+       linear, slope or breakpoint table alike.
+
+  Side: The record is set to INVALID if the channel has no
+        filter or no average has been filtered yet.
+
+  Ret: long
+         OK                 - Successful operation (convert rval->val)
+         ANLG_NO_CONVERSION - Successful operation (no conversion)
+         ERROR              - No filter output
+
+=============================================================*/
+static long read_ai_ave(void *rec_p)
+{
+   long                 out  = 0;
+   long                 half = 1L << (HY8413_FILT_FRAC-1);
+   DPVT_ID              devPvt_ps  = NULL;
+   epicsTimeStamp      *time_p     = NULL;
+   struct aiRecord     *rec_ps     = (struct aiRecord *)rec_p;
+
+   devPvt_ps = (DPVT_ID)rec_ps->dpvt;
+   if ( !devPvt_ps ) 
+   {
+       recGblSetSevr(rec_ps,READ_ALARM,INVALID_ALARM);
+       return(ERROR);
+   }
+#ifdef epicsTimeEventDeviceTime
+   if ( rec_ps->tse == epicsTimeEventDeviceTime ) time_p = &rec_ps->time;
+#endif
+   if ( drvHy8413_filt_rd( devPvt_ps->card_ps, devPvt_ps->i, &out, time_p ) != OK )
+   {
+       recGblSetSevr(rec_ps,READ_ALARM,INVALID_ALARM);
+       return(ERROR);
+   }
+
+   if ( !rec_ps->linr )
+   {
+       rec_ps->val = (double)out/(1L << HY8413_FILT_FRAC);
+       rec_ps->udf = 0;
+       return(ANLG_NO_CONVERSION);
+   }
+   rec_ps->rval = ((out >= 0) ? out + half : out - half)/(1L << HY8413_FILT_FRAC);
+   return(OK);
+}
+
+/*=============================================================
+
+  Abs:  Device Support initialization, direct EGU conversion
+
+  Name: init_ai_egu
+
+  Args: rec_p                          Record information
+          Use:  struct
+          Type: aiRecord *
+          Acc:  read-write access
+          Mech: By reference
+
+  Rem:  This routine initializes an analog input record as
+        init_ai does and sets up the EGU coefficients of its
+        channel from EGUF and EGUL, see drvHy8413_cal_egu_set().
+        With EGUF equal to EGUL the record reads volts.
+
+  Side: None
+
+  Ret: long
+         OK               - Successful operation
+         Otherwise see failed return from init_ai()
+
+=============================================================*/
+static long init_ai_egu(void *rec_p)
+{
+    long                 status;
+    DPVT_ID              devPvt_ps;
+    struct aiRecord     *rec_ps = (struct aiRecord *)rec_p;
+
+    status = init_ai( rec_p );
+    if ( status!=OK ) return(status);
+
+    devPvt_ps         = (DPVT_ID)rec_ps->dpvt;
+    devPvt_ps->egu_ps = callocMustSucceed( 1, sizeof(hytec_ipmCalEgu_ts), "init_ai_egu()" );
+    drvHy8413_cal_egu_set( devPvt_ps->card_ps,
+                           devPvt_ps->i,
+                           rec_ps->egul,
+                           rec_ps->eguf,
+                           devPvt_ps->egu_ps );
+    return(status);
+}
+
+/*=============================================================
+
+  Abs:  Input device support read in EGU
+
+  Name: read_ai_egu
+
+  Args: rec_p                      Record information
+          Use:  struct
+          Type: void *
+          Acc:  read-write access
+          Mech: By reference
+
+  Rem: This routine processes an analog input record reading
+       the raw channel from the snapshot of the card and
+       converting it to EGU in one step with the coefficients
+       of the channel, which fold the calibration, the data
+       format and EGUF/EGUL. The record does no conversion,
+       ASLO/AOFF are not applied. RVAL is the raw value.
+
+  Side: The record is set to INVALID if the read fails.
+
+  Ret: long
+         ANLG_NO_CONVERSION - Successful operation
+         ERROR              - Read failed
+
+=============================================================*/
+static long read_ai_egu(void *rec_p)
+{
+   unsigned short       rval       = 0;
+   DPVT_ID              devPvt_ps  = NULL;
+   epicsTimeStamp      *time_p     = NULL;
+   struct aiRecord     *rec_ps     = (struct aiRecord *)rec_p;
+
+   devPvt_ps = (DPVT_ID)rec_ps->dpvt;
+   if ( !devPvt_ps || !devPvt_ps->egu_ps ) 
+   {
+       recGblSetSevr(rec_ps,READ_ALARM,INVALID_ALARM);
+       return(ERROR);
+   }
+#ifdef epicsTimeEventDeviceTime
+   if ( rec_ps->tse == epicsTimeEventDeviceTime ) time_p = &rec_ps->time;
+#endif
+   if ( drvHy8413_snap_rd( devPvt_ps->card_ps,
+                           devPvt_ps->i,
+                           0,
+                           &devPvt_ps->gen,
+                           (short *)&rval,
+                           time_p ) != OK )
+   {
+       recGblSetSevr(rec_ps,READ_ALARM,INVALID_ALARM);
+       return(ERROR);
+   }
+
+   /* EGUF/EGUL changed with LINR not LINEAR, no special_linconv call */
+   if ( (rec_ps->eguf != devPvt_ps->egu_ps->eguf) || (rec_ps->egul != devPvt_ps->egu_ps->egul) )
+      drvHy8413_cal_egu_set( devPvt_ps->card_ps,
+                             devPvt_ps->i,
+                             rec_ps->egul,
+                             rec_ps->eguf,
+                             devPvt_ps->egu_ps );
+   rec_ps->rval = rval;
+   rec_ps->val  = drvHy8413_cal_egu( devPvt_ps->card_ps,
+                                     devPvt_ps->i,
+                                     devPvt_ps->egu_ps,
+                                     rval );
+   rec_ps->udf  = 0;
+   return(ANLG_NO_CONVERSION);
+}
+
 /*=============================================================
 
   Abs:  Linear conversion routine
@@ -325,3 +551,45 @@ static long special_linconv_ai(void *rec_p,int after)
   return(status);
 }
 
+
+/*=============================================================
+
+  Abs:  EGU coefficients update
+
+  Name: special_linconv_ai_egu
+
+  Args: rec_p                      Record information
+          Use:  struct
+          Type: void *
+          Acc:  read-write access
+          Mech: By reference
+
+        after                      After the field change
+          Use:  integer
+          Type: int
+          Acc:  read-only access
+          Mech: By value
+
+  Rem: This routine is called when EGUF or EGUL is changed
+       and sets up the EGU coefficients of the channel again.
+
+  Side: None
+
+  Ret: long
+         OK     - Successful operation (always)
+
+=============================================================*/
+static long special_linconv_ai_egu(void *rec_p,int after)
+{
+  DPVT_ID           devPvt_ps;
+  struct aiRecord  *rec_ps = (struct aiRecord *)rec_p;
+
+  devPvt_ps = (DPVT_ID)rec_ps->dpvt;
+  if ( after && devPvt_ps && devPvt_ps->egu_ps )
+     drvHy8413_cal_egu_set( devPvt_ps->card_ps,
+                            devPvt_ps->i,
+                            rec_ps->egul,
+                            rec_ps->eguf,
+                            devPvt_ps->egu_ps );
+  return(OK);
+}
@@ -16,6 +16,8 @@
 
 -------------------------------------------------------------
   Mod:
+        17-Oct-2026, agent            (AGENT):
+          read ACR and CSR bits from the card register shadow
         08-Nov-2006, K. Luchini       (LUCHINI):
           cast arg 1 in hy8413_rd() to void ptr
 
@@ -236,7 +238,6 @@ static long read_bi(void *rec_p)
    unsigned short     i = 0;           /* channel index            */
    unsigned short     cur_stat   = READ_ALARM;  /* alarm status    */
    unsigned short     cur_sevr   = INVALID_ALARM;/* alarm severity */
-   HY8413_IO          io_ps      = NULL;
    DPVT_ID            devPvt_ps  = NULL;
    IPADC_ID           card_ps    = NULL;
    struct biRecord   *rec_ps      = (struct biRecord *)rec_p;
@@ -261,12 +262,12 @@ static long read_bi(void *rec_p)
 
    devPvt_ps = (DPVT_ID)rec_ps->dpvt;
    card_ps   = devPvt_ps->card_ps;
-   io_ps     = (HY8413_IO)card_ps->io_p;
    switch( devPvt_ps->func ) 
    {
        case ReadACR:
           mask <<= devPvt_ps->i-1;
-          val  = io_ps->acr & mask;
+          status = drvHy8413_snap_reg_rd( card_ps, HY8413_REG_ACR, &devPvt_ps->gen, &val );
+          val &= mask;
           rec_ps->rval = (val) ? 1 : 0;
           if (debugDevHy8413==1)
             printf("%s: mask=0x%hd\tval=0x%hd for %s\n",taskName_c,mask,val,rec_ps->name);
@@ -274,7 +275,8 @@ static long read_bi(void *rec_p)
 
        case ReadCSR:
   	  mask <<= devPvt_ps->i-1;
-          val  = io_ps->csr & mask;
+          status = drvHy8413_snap_reg_rd( card_ps, HY8413_REG_CSR, &devPvt_ps->gen, &val );
+          val &= mask;
           rec_ps->rval = (val) ? 1 : 0;
           if (debugDevHy8413==1)
             printf("%s: mask=0x%hd\tval=0x%hd for %s\n",taskName_c,mask,val,rec_ps->name);
@@ -15,6 +15,11 @@
 
 -------------------------------------------------------------
   Mod:
+        17-Oct-2026, agent            (AGENT):
+          follow ACR range/format changes with drvHy8413_cal_check()
+          write the ACR through drvHy8413_acr_wt()
+          add DATA software triggered capture
+          mark the ACR/CSR shadow stale after a write
         08-Nov-2006, K. Luchini       (LUCHINI):
           cast arg 1 in hy8413_rd() to void ptr
 
@@ -143,6 +148,7 @@ static long init_bo(void *rec_p)
        The following hardware registers 
          CSR - Control Register
          ACR - Auxilliary Control Register 
+       or, for DATA, starts a software triggered capture.
 
   Side: None
 
@@ -191,11 +197,7 @@ static long write_bo(void *rec_p)
    {
        case SetACR:
           mask <<= devPvt_ps->i;
-	  if ( rec_ps->rval ) 
-
-	   io_ps->acr &= ~mask;  /* clear bit */
-          else
-            io_ps->acr |= mask;  /* set bit  */
+          status = drvHy8413_acr_wt( card_ps, mask, rec_ps->rval ? 0 : mask );
           break;
 
        case SetCSR:
@@ -204,6 +206,7 @@ static long write_bo(void *rec_p)
             io_ps->csr &= ~mask;  /* clear bit */
           else
             io_ps->csr |= mask;   /* set bit  */  
+          drvHy8413_snap_reg_touch( card_ps );
           break;
 
      /* 
@@ -226,6 +229,16 @@ static long write_bo(void *rec_p)
            card_ps->cal_s.chan_as[i].enb = 1;   /* use calibration data       */
 	 break;
 
+     /*
+      * Software triggered capture of the FIFO. The samples are
+      * posted to the waveform records when the capture is done,
+      * so the record does not wait for it.
+      */
+      case SetDATA:
+         if ( rec_ps->rval )
+           status = drvHy8413_fifo_soft( card_ps, 0 );
+         break;
+
        default:
           status = ERROR;
           break;
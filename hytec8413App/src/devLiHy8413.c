@@ -6,6 +6,7 @@
   Name: devLiHy8413.c
 
          *   init_li  - initialization binary input 
+         *   get_ioint_info_li  - Get I/O event list info
          *   read_li  - read binary input state
 
    Proto: None
@@ -15,8 +16,9 @@
 
 -------------------------------------------------------------
   Mod:
-        dd-mmm-yyyy, First Lastname   (USERNAME):
-          comment
+        17-Oct-2026, agent            (AGENT):
+          add DATA records for the external FIFO status items
+          (trigger sample number, pre-trigger and captured groups)
 
 =============================================================
 */
@@ -50,6 +52,7 @@
 /* Local prototypes */
 static long init_li( void *rec_p );
 static long read_li( void *rec_p ); 
+static long get_ioint_info_li( int cmd, void *rec_p, IOSCANPVT *evt_pp );
 
 /* Global variables */
 extern int debugDevHy8413;
@@ -64,7 +67,7 @@ typedef struct {
      DEVSUPFUN  read_write;      /* ptr to write function        */
 } DSET;
  
-DSET devLiHy8413    = {5, NULL, NULL, init_li, NULL, read_li};
+DSET devLiHy8413    = {5, NULL, NULL, init_li, get_ioint_info_li, read_li};
 epicsExportAddress(dset,devLiHy8413);
 
 
@@ -128,6 +131,57 @@ static long init_li(void *rec_p)
 }
 
 
+/*=============================================================
+
+  Abs:  Device Support for io scanner init
+
+  Name: get_ioint_info_li
+
+  Args: cmd                        Command being performed
+          Use:  integer
+          Type: int
+          Acc:  read-only
+          Mech: By value
+
+        rec_p                      Record information
+          Use:  struct
+          Type: void *
+          Acc:  read-write access
+          Mech: By reference
+
+        evt_pp                     I/O scan event
+          Use:  struct
+          Type: IOSCANPVT *
+          Acc:  read-write access
+          Mech: By reference
+
+  Rem:  This device support provides access to the IOSCANPVT
+        structure that is scanned when new FIFO capture data
+        is available, for the FIFO status (DATA) records.
+
+  Side: None
+
+  Ret: long
+            OK - Successful operation (always returned)
+
+=============================================================*/
+static long get_ioint_info_li( int cmd, void *rec_p, IOSCANPVT *evt_pp )
+{
+    long                  status=OK;          /* status return        */
+    DPVT_ID               devPvt_ps = NULL;   /* private device info  */
+    struct longinRecord  *rec_ps;             /* long input record    */
+
+
+    rec_ps  = (struct longinRecord *)rec_p;
+    if (rec_ps->dpvt) 
+    {
+       devPvt_ps = rec_ps->dpvt;
+       *evt_pp   = devPvt_ps->card_ps->fifo_s.wfScan;
+    }
+    return( status );
+}
+
+
 /*=============================================================
 
   Abs:  Long Input device support 
@@ -143,6 +197,9 @@ static long init_li(void *rec_p)
   Rem: This routine processes a binary output  record.
        The following hardware registers 
          ID - Id Prom Registers 
+         IO - IO Registers
+       and the external FIFO status items
+         DATA - see hy8413_fifoItem_te
 
   Side: None
 
@@ -158,6 +215,7 @@ static long read_li(void *rec_p)
 {
    long                      status=OK;       /* status return            */
    unsigned short            val;             /* raw value                */
+   unsigned long             lval = 0;        /* fifo status item value   */
    unsigned short            i = 0;           /* channel index            */
    unsigned short            cur_stat   = READ_ALARM;  /* alarm status    */
    unsigned short            cur_sevr   = INVALID_ALARM;/* alarm severity */
@@ -206,6 +264,14 @@ static long read_li(void *rec_p)
 		taskName_c,i,val,val,rec_ps->name);
          break;
 
+       case ReadDATA:
+         status = drvHy8413_fifo_item( card_ps, i, &lval );
+         rec_ps->val = (long)lval;
+         if ( debugDevHy8413==0x8)
+           printf("%s: fifo item=%hd val=%lu for %s\n",
+                 taskName_c,i,lval,rec_ps->name);
+         break;
+
        default:
           if ( debugDevHy8413==0x8)
           printf("%s:  devSup (func=%hd) has not been implimented for %s\n",
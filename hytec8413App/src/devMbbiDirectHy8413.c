@@ -16,6 +16,9 @@
 
 -------------------------------------------------------------
   Mod:
+        17-Oct-2026, agent            (AGENT):
+          read ACR and CSR from the card register shadow,
+          ReadCSR now returns the CSR rather than the ACR
         08-Nov-2006, K. Luchini       (LUCHINI):
           cast arg 1 in hy8413_rd() to void ptr
 
@@ -228,11 +231,11 @@ static long get_ioint_info_mbbiDirect( int        cmd,
 static long read_mbbiDirect(void *rec_p)
 {
    long                      status=OK;      /* status return            */
+   unsigned short            val   = 0;      /* register value           */
    unsigned short            cur_stat   = READ_ALARM;  /* alarm status    */
    unsigned short            cur_sevr   = INVALID_ALARM;/* alarm severity */
    DPVT_ID                   devPvt_ps  = NULL;
    IPADC_ID                  card_ps    = NULL;
-   HY8413_IO                 io_ps      = NULL;
    struct mbbiDirectRecord  *rec_ps     = (struct mbbiDirectRecord *)rec_p;
    char                     *taskName_c = "devMbbiDirectHy8413( read )";
 
@@ -257,15 +260,16 @@ static long read_mbbiDirect(void *rec_p)
   
    devPvt_ps = (DPVT_ID)rec_ps->dpvt;
    card_ps   = devPvt_ps->card_ps;
-   io_ps     = (HY8413_IO)card_ps->io_p;
    switch( devPvt_ps->func ) 
    {
         case ReadACR:
-          rec_ps->rval = io_ps->acr & HY8413_ACR_MASK;
+          status = drvHy8413_snap_reg_rd( card_ps, HY8413_REG_ACR, &devPvt_ps->gen, &val );
+          rec_ps->rval = val & HY8413_ACR_MASK;
           break;
 
         case ReadCSR:
-          rec_ps->rval = io_ps->acr & HY8413_CSR_MASK;
+          status = drvHy8413_snap_reg_rd( card_ps, HY8413_REG_CSR, &devPvt_ps->gen, &val );
+          rec_ps->rval = val & HY8413_CSR_MASK;
           break;
 
       default:
@@ -16,6 +16,8 @@
 
 -------------------------------------------------------------
   Mod:
+        17-Oct-2026, agent            (AGENT):
+          read ACR fields from the card register shadow
         08-Nov-2006, K. Luchini       (LUCHINI):
           cast arg 1 in hy8413_rd() to void ptr
 
@@ -234,7 +236,6 @@ static long read_mbbi(void *rec_p)
    unsigned short      cur_sevr   = INVALID_ALARM;/* alarm severity */
    DPVT_ID             devPvt_ps  = NULL;
    IPADC_ID            card_ps    = NULL;
-   HY8413_IO           io_ps      = NULL;
    volatile unsigned short *io_a  = NULL;
    struct mbbiRecord       *rec_ps     = (struct mbbiRecord *)rec_p;
    char                    *taskName_c = "devMbbiHy8413( read )";
@@ -263,9 +264,9 @@ static long read_mbbi(void *rec_p)
    switch( devPvt_ps->func ) 
    {
       case ReadACR: 
-         io_ps = (HY8413_IO)card_ps->io_p;
          mask  = (unsigned short)pow(2,rec_ps->nobt)-1;
-  	 val   = io_ps->acr & HY8413_ACR_MASK;
+         status = drvHy8413_snap_reg_rd( card_ps, HY8413_REG_ACR, &devPvt_ps->gen, &val );
+         val  &= HY8413_ACR_MASK;
          rec_ps->rval = (val>>devPvt_ps->i) & mask; 
          if ( debugDevHy8413==2)
            printf("%s: ACR value=0x%hx bitNo=%hd mask=0x%hx value=0x%lx for %s\n",
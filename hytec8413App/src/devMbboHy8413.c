@@ -14,6 +14,10 @@
 
 -------------------------------------------------------------
   Mod:
+        17-Oct-2026, agent            (AGENT):
+          mark the ACR/CSR shadow stale after a register write
+          write the ACR through drvHy8413_acr_wt(), so that
+          range and format changes are followed
         05-Dec-2007, K. Luchini       (LUCHINI):
           add SetIO to write_mbbo()
         08-Nov-2006, K. Luchini       (LUCHINI):
@@ -44,6 +48,7 @@
 #include "drvIpac.h"          /* ipac_idProm_t             */
 #include "hytecIpm.h"         /* for IPADC_ID,DPVT_ID      */
 #include "hytecIpmLib.h"      /* for hytec_ipmInitDev()    */
+#include "drvHy8413.h"        /* for HY8413_IO             */
 #include "drvHy8413Lib.h"     /* for drvHy8413_rd() proto  */
 #include "epicsExport.h"
 
@@ -199,7 +204,13 @@ static long write_mbbo(void *rec_p)
           mask <<= rec_ps->nobt;
           mask  -= 1;
           val  = (unsigned short)rec_ps->val;
-          io_a[devPvt_ps->i] =  val & mask;
+          if ( &io_a[devPvt_ps->i] == &((HY8413_IO)io_a)->acr )
+            status = drvHy8413_acr_wt( card_ps, 0xffff, val & mask );
+          else
+          {
+            io_a[devPvt_ps->i] =  val & mask;
+            drvHy8413_snap_reg_touch( card_ps );
+          }
           if (debugDevHy8413==0x10)
 	    printf("%s: devSup has not been implimented to support ACR\n",taskName_c);
           
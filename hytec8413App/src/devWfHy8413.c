@@ -6,7 +6,9 @@
 
   Name: devWfHy8413.c
          *   init_wf     - initialization
+         *   get_ioint_info_wf  - Get I/O event list info
          *   read__wf    - read analog input
+         *   volts_wf    - convert a raw sample to volts
 
    Proto: None
 
@@ -15,8 +17,13 @@
 
 -------------------------------------------------------------
   Mod:
-        dd-mmm-yyyy, First Lastname   (USERNAME):
-          comment
+        17-Oct-2026, agent            (AGENT):
+          add DATA waveforms of the captured external FIFO
+          samples of one channel (USHORT, FLOAT or DOUBLE).
+          fix record pointer and ID loop in read_wf()
+          swap raw DATA waveform buffers with the driver pool
+          calibrate with drvHy8413_cal_val(), which uses the tables if built
+          calibrate DATA waveforms a block at a time
 
 =============================================================
 */
@@ -29,6 +36,7 @@
 #include "epicsVersion.h"
 #include "epicsMutex.h"
 #include "epicsString.h"
+#include "epicsTime.h"
 #if (EPICS_REVISION == 14 && EPICS_MODIFICATION >= 11) || (EPICS_REVISION == 15) || (EPICS_VERSION == 7)
 #include  "errlog.h"
 #endif
@@ -49,9 +57,20 @@
 #include "epicsExport.h"
 
 
+/* 
+ * Record support picks up a new BPTR in get_array_info()
+ * from EPICS 3.16 on, so raw waveforms can swap buffers with
+ * the driver pool instead of copying the samples.
+ */
+#if (EPICS_VERSION == 7) || (EPICS_REVISION >= 16)
+#define HY8413_WF_SWAP
+#endif
+
 /* Local prototypes */
 static long init_wf( void *rec_p );
 static long read_wf( void *rec_p );
+static long get_ioint_info_wf( int cmd, void *rec_p, IOSCANPVT *evt_pp );
+static double volts_wf( IPADC_ID card_ps, int cal, unsigned short rval );
 
 /* 
  * Global variables - device support entry table 
@@ -69,7 +88,7 @@ struct {
         NULL,
         NULL,
         init_wf,
-        NULL,
+        get_ioint_info_wf,
         read_wf };
 
 epicsExportAddress(dset,devWfHy8413);
@@ -91,7 +110,9 @@ epicsExportAddress(dset,devWfHy8413);
         support function init_record(). Its purpose it to
         initializes analog input array records.
 
-  Side: INST_IO is the only bus type supported
+  Side: INST_IO is the only bus type supported.
+        DATA waveforms require the FIFO interrupts to be
+        setup for the card (see ip8413Create mask).
 
   Ret: long
          OK               - Successful operation
@@ -103,7 +124,6 @@ epicsExportAddress(dset,devWfHy8413);
 static long init_wf(void *rec_p)
 {
     long                          status = OK;
-    unsigned short                i      = 0;         /* channel number                  */
     unsigned short                type   = TYPE_WF;   /* channel data                    */
     static const unsigned short   nelm   = 5;         /* number elmements in func_s list */
     struct instio                *instio_ps = NULL;
@@ -124,9 +144,32 @@ static long init_wf(void *rec_p)
           {
             devPvt_ps = (DPVT_ID)rec_ps->dpvt;
             card_ps   = devPvt_ps->card_ps;
-            i         = devPvt_ps->i;
-            if ( (rec_ps->ftvl != menuFtypeUSHORT) || (rec_ps->nelm < MAX_CAL_PTS) )
-              status = S_dev_badInpType;
+            switch( devPvt_ps->func )
+            {
+              case ReadID:
+                if ( (rec_ps->ftvl != menuFtypeUSHORT) || (rec_ps->nelm < MAX_CAL_PTS) )
+                  status = S_dev_badInpType;
+                break;
+
+              case ReadDATA:
+                if ( !card_ps->intHandler )
+                {
+                  errlogPrintf("%s: FIFO interrupts not setup for card %s\n",rec_ps->name,card_ps->name_c);
+                  status = S_dev_badInpType;
+                }
+                else if ( (rec_ps->ftvl != menuFtypeUSHORT) &&
+                          (rec_ps->ftvl != menuFtypeFLOAT)  &&
+                          (rec_ps->ftvl != menuFtypeDOUBLE) )
+                  status = S_dev_badInpType;
+#ifdef HY8413_WF_SWAP
+                else if ( (rec_ps->ftvl == menuFtypeUSHORT) && (rec_ps->nelm == HY8413_WF_NELM) )
+                  card_ps->wf_s.nrec++;
+#endif
+                break;
+
+              default:
+                break;
+            }
 	  }  
           else
             status = S_dev_badRequest;                  
@@ -146,6 +189,57 @@ static long init_wf(void *rec_p)
 }
 
 
+/*=============================================================
+
+  Abs:  Device Support for io scanner init
+
+  Name: get_ioint_info_wf
+
+  Args: cmd                        Command being performed
+          Use:  integer
+          Type: int
+          Acc:  read-only
+          Mech: By value
+
+        rec_p                      Record information
+          Use:  struct
+          Type: void *
+          Acc:  read-write access
+          Mech: By reference
+
+        evt_pp                     I/O scan event
+          Use:  struct
+          Type: IOSCANPVT *
+          Acc:  read-write access
+          Mech: By reference
+
+  Rem:  This device support provides access to the IOSCANPVT
+        structure that is scanned when new FIFO capture data
+        is available for the card defined for this pv.
+
+  Side: None
+
+  Ret: long
+            OK - Successful operation (always returned)
+
+=============================================================*/
+static long get_ioint_info_wf( int cmd, void *rec_p, IOSCANPVT *evt_pp )
+{
+    long                   status=OK;          /* status return        */
+    DPVT_ID                devPvt_ps = NULL;   /* private device info  */
+    struct waveformRecord *rec_ps;             /* waveform record      */
+
+
+    rec_ps  = (struct waveformRecord *)rec_p;
+    if (rec_ps->dpvt) 
+    {
+       devPvt_ps = rec_ps->dpvt;
+       *evt_pp   = devPvt_ps->card_ps->fifo_s.wfScan;
+    }
+    return( status );
+}
+
+
 /*=============================================================
 
   Abs:  Input device support read
@@ -162,6 +256,12 @@ static long init_wf(void *rec_p)
        The floating point read from the specified hardware
        memeory location, and stored into the VAL field.
 
+       For DATA waveforms the most recent captured samples
+       of the channel are returned as raw counts (USHORT)
+       or as calibrated volts (FLOAT or DOUBLE). Raw records
+       of HY8413_WF_NELM elements swap BPTR with the driver
+       buffer pool when possible, rather than copying.
+
   Side: None
 
   Ret: long
@@ -178,6 +278,10 @@ static long read_wf(void *rec_p)
    long                   status=OK;       /* status return            */
    short                  i          = 0;  /* index                    */
    short                  j          = 1;  /* increment counter        */
+   unsigned long          n          = 0;  /* number of elements read  */
+   unsigned long          k          = 0;  /* element index            */
+   double                 dval       = 0.0;/* sample in volts          */
+   int                    cal        = 0;  /* samples calibrated       */
    unsigned short        *data_a     = NULL;    
    unsigned short         cur_stat   = READ_ALARM;   /* alarm status   */
    unsigned short         cur_sevr   = INVALID_ALARM;/* alarm severity */
@@ -193,7 +297,7 @@ static long read_wf(void *rec_p)
     * filled in then we have a problem and so
     * just exit successfully.  Otherwise, continue.
     */
-   rec_ps = (struct waveformRecord *)rec_ps;
+   rec_ps = (struct waveformRecord *)rec_p;
    if ( !rec_ps->dpvt ) 
    {
        status = recGblSetSevr(rec_ps,cur_stat,cur_sevr);
@@ -221,10 +325,52 @@ static long read_wf(void *rec_p)
 
           /* Read calibration data */
           if ( card_ps->cal_s.type==factor_3pt ) j=2; 
-	  for (i=0,j=0; i<MAX_CAL_PTS; i+=j) 
-	    data_a[i] = cal_ps->gain_a[card_ps->format][i];
+	  for (i=0,n=0; i<MAX_CAL_PTS; i+=j) 
+	    data_a[n++] = cal_ps->gain_a[card_ps->format][i];
 	} 
         break;
+
+      case ReadDATA:
+        i      = devPvt_ps->i;
+#ifdef HY8413_WF_SWAP
+        /* Take the channel buffer of the latest capture */
+        n = rec_ps->nord;
+        if ( (rec_ps->ftvl == menuFtypeUSHORT) && (rec_ps->nelm == HY8413_WF_NELM) &&
+             (drvHy8413_wf_take( card_ps, i, &rec_ps->bptr, &n, &devPvt_ps->gen ) == OK) )
+        {
+#ifdef epicsTimeEventDeviceTime
+          if ( rec_ps->tse == epicsTimeEventDeviceTime )
+            rec_ps->time = card_ps->fifo_s.time;
+#endif
+          break;
+        }
+#endif
+        data_a = (unsigned short *)rec_ps->bptr;
+        n      = drvHy8413_fifo_rd_chan( card_ps, i, data_a, rec_ps->nelm );
+
+        /* 
+         * Calibrate the block in place, then convert in place,
+         * starting from the last sample since the floating point
+         * elements are wider than the raw samples.
+         */
+        if ( rec_ps->ftvl != menuFtypeUSHORT )
+        {
+          cal = (drvHy8413_cal_chan_blk( card_ps, i, data_a, data_a, n ) == OK);
+          for (k=n; k>0; ) 
+          {
+            k--;
+            dval = volts_wf( card_ps, cal, data_a[k] );
+            if ( rec_ps->ftvl == menuFtypeFLOAT )
+              ((float *)rec_ps->bptr)[k] = (float)dval;
+            else
+              ((double *)rec_ps->bptr)[k] = dval;
+          }
+        }
+#ifdef epicsTimeEventDeviceTime
+        if ( rec_ps->tse == epicsTimeEventDeviceTime )
+          rec_ps->time = card_ps->fifo_s.time;
+#endif
+        break;
           
       default:
         printf("%s:  devSup has not been implimented for %s\n",taskName_c,rec_ps->name);
@@ -232,8 +378,57 @@ static long read_wf(void *rec_p)
 	  break;    
    }/* End of switch statement */
 
-   rec_ps->nord = i-1;
+   rec_ps->nord = n;
    if (status!=OK)
       recGblSetSevr((dbCommon *)rec_p,cur_stat,cur_sevr);
    return(status);
 }
+
+/*=============================================================
+
+  Abs:  Convert a raw sample to volts
+
+  Name: volts_wf
+
+  Args: card_ps                    Card information
+          Use:  struct
+          Type: IPADC_ID
+          Acc:  read-only access
+          Mech: By reference
+
+        cal                        Sample is calibrated
+          Use:  integer
+          Type: int
+          Acc:  read-only access
+          Mech: By value
+
+        rval                       Raw adc sample
+          Use:  integer
+          Type: unsigned short
+          Acc:  read-only access
+          Mech: By value
+
+  Rem: This routine scales a sample to the voltage range of
+       the module. A calibrated sample is in offset binary,
+       otherwise the data format of the module is used.
+
+  Side: None
+
+  Ret: double
+         Sample in volts
+
+=============================================================*/
+static double volts_wf( IPADC_ID card_ps, int cal, unsigned short rval )
+{
+   long                 counts = 0;
+   double               fs     = 10.0;
+
+   if ( card_ps->range == five_plus_minus ) fs = 5.0;
+   if ( cal )
+      counts = (long)rval - OFFSET_BINARY_ZERO;
+   else if ( card_ps->format == offset_binary )
+      counts = (long)rval - OFFSET_BINARY_ZERO;
+   else
+      counts = (short)rval;
+   return( ((double)counts * fs)/32768.0 );
+}
@@ -10,17 +10,20 @@
              drvHy8413_dump_adc_data - Report adc data of a single card
              drvHy8413_dump_cal_data - Report calibration data for a single card 
              drvHy8413_rd            - Read specified channel data
+             drvHy8413_rd_block      - Read all adc and reference registers
 	  *  drvHy8413_rd_cal_type   - read calibration type from id prom
           *  drvHy8413_rd_cal_data   - read calibration data from id prom
           *  drvHy8413_rd_cal_page   - read channel data from a specified id prom page
-             drvHy8413_cal_adc       - calibrate raw adc data
              drvHy8413_wt_page       - set the id prom page in the auxillary control register
+             drvHy8413_acr_wt        - write bits of the auxillary control register of a card
              drvHy8413_ARM           - start/stop sampling adc data at sample rate
              drvHy8413_wt_clk_rate   - set the clock rate register
              drvHy8413_rd_clk_rate   - read the clock rate register
              drvHy8413_init_sam_mode - Initilize the SAM Readout Mode in the ACR (v2 only)
+             drvHy8413_init_ave_mode - Initilize the averager in polling mode (v2 only)
              drvHy8413_init          - Module initialization called before iocInit()
              ip8413Create            - Module specific Wrapper for hyec_addIpAdc()
+             ip8413RdBench           - Benchmark single and block register reads
  
           * indicates static routines
   
@@ -33,6 +36,20 @@
   Mod:  
         08-Nov-2006, K. Luchini (LUCHINI):
            Fix formatting error in hy8413_dump         
+        17-Oct-2026, agent            (AGENT):
+           Add drvHy8413_rd_block, D32 carrier mask bit and ip8413RdBench
+           Start the SAM buffer watcher in drvHy8413_init_driver
+           Add drvHy8413_init_ave_mode, averager polling mode mask bit
+           Build the calibration tables when requested by the mask
+           Set up the fixed-point calibration segments at init
+           Read the calibration data from the cache file when it has the module
+           Read the calibration data of both ranges, fix the page loop
+           and the id prom offset of each channel on a page
+           Report the drift correction
+           Add drvHy8413_acr_wt for all ACR writes from records
+           Write the calibration cache once, in drvHy8413_init_driver
+           Move drvHy8413_cal_adc to drvHy8413Cal.c
+           Drop the ADN/BUF write to the CSR in drvHy8413_init_sam_mode
  
 =============================================================
 */
@@ -47,6 +64,7 @@
 #include "epicsMutex.h"
 #include "epicsString.h"
 #include "epicsInterrupt.h"
+#include "epicsTime.h"
 #include "errlog.h"
 #include "cantProceed.h"
 #include "drvSup.h"
@@ -99,7 +117,10 @@ epicsExportAddress(drvet,drvHy8413);
        determine which ip-adc-8413 module(s) are
        present in the local ioc and then to
        perform the initialization sequence on
-       each.
+       each. The averager watcher of cards with
+       the averager enabled is started here, and
+       the calibration cache is written if cards
+       were read from their id prom.
  
   Side: None
  
@@ -118,8 +139,10 @@ static long drvHy8413_init_driver( void )
    while( card_ps ) 
    {
       card_ps->init = 1;
+      drvHy8413_sam_start( card_ps );
       card_ps = (IPADC_ID)ellNext((ELLNODE *)card_ps);
    }/* End of while statement */
+   drvHy8413_cache_flush();
    return(status);
 }
 
@@ -251,6 +274,12 @@ static void drvHy8413_dump( int  level,
        printf("\tInitialized Successfully\n");
      else
        printf("\tFailed Initialization\n");
+     drvHy8413_fifo_report( card_ps );
+     drvHy8413_snap_report( card_ps );
+     drvHy8413_sam_report( card_ps );
+     drvHy8413_filt_report( card_ps );
+     drvHy8413_cal_report( card_ps );
+     drvHy8413_drift_report( card_ps );
   }
 
   if (level>=2)
@@ -451,135 +480,70 @@ long drvHy8413_rd( volatile unsigned short  * const  io_p,
 
 /*====================================================
  
-  Abs:  Calculate adc value using calibration data
+  Abs:  Read all adc and reference registers
  
-  Name: drvHy8413_cal_adc
+  Name: drvHy8413_rd_block
  
-  Args: gain_a                          Gain values 
-          Type: array                   Note: 5 element.
-          Use:  unsigned short const * const           
+  Args: io_p                            Base io address Card
+          Type: pointer               
+          Use:  volatile unsigned short * const           
           Acc:  read-only               
           Mech: By reference            
  
-        calType                         Calibration type  
-          Type: integer                 Note: none
-          Use:  unsigned short                1 = 3-point
-          Acc:  read-only                     2 = 5-point
-          Mech: By value
-
-        format                          Data format  
-          Type: integer                 Note: 1=offste binary
-          Use:  unsigned short                0=two's compliment
-          Acc:  read-only
+        d32                             Use 32-bit accesses
+          Type: integer                 Note: only if the carrier
+          Use:  unsigned short                allows D32 (see
+          Acc:  read-only                     HY8413_MASK_D32)
           Mech: By value
 
-        rval                             Raw data value
-          Type: integer                  
-          Use:  long               
-          Acc:  read-only                
-          Mech: By value                      
- 
+        val_a                           Register values
+          Type: array                   Note: HY8413_ADC_NREG
+          Use:  unsigned short * const        elements
+          Acc:  write-only                
+          Mech: By reference                      
  
-  Rem: This function calibrates the raw adc value 
-       supplied as an input argument. 
+  Rem: This function reads the 16 adc buffer registers and the
+       0V and 2.5V reference registers, which are consecutive
+       in io space, in one pass. With d32 set, each pair of
+       registers is read with one 32-bit access, which halves
+       the number of bus cycles. The registers are returned in
+       address order, channel 0 first and the references at
+       HY8413_ADC_REF0 and HY8413_ADC_REF25.
 
   Side: None
  
-  Ret:  long 
-             calibrated 32-bit value
+  Ret:  long
+             Number of bus cycles used
  
-=======================================================*/ 
-long drvHy8413_cal_adc( unsigned short  const * const gain_a,
-                        unsigned short                calType,
-                        unsigned short                format,
-                        long                          rval )
+=======================================================*/
+long drvHy8413_rd_block( volatile unsigned short  * const  io_p,
+                         unsigned short                    d32,
+                         unsigned short           * const  val_a )
 {
-     hy8413_calData_ts *cal_ps = (hy8413_calData_ts *)gain_a;
-     double             scale=0.0;
-     double             dval=0.0;
-     long               offset=0;
-     long               resol=65535;
-     long               rng=0;
- /*  long               zero_a[2]={TWOS_COMPLIMENT_ZERO,OFFSET_BINARY_ZERO}; */
-     long               ref_rng_a[2]={0x3ff8,0x3ff9};
-     long               offset_a[4]= {0xbff8,  /* -15V in counts remaining, from -10 to +5V  */
-                                      0x7fff,  /* -10V in counts remaining, from -10 to  0V  */
-                                      0x8000,  /* +10V in counts remaining, from   0 to +10V */
-                                      0x4007}; /* +15V in counts remaining, from +10 to -5V  */
-                                     
-     switch(calType) 
-     {
-       /* 
-	* Five point calibration with reference voltages at
-	* -10V, -5V, 0V, +5V and +10V.
-        * This gives us four linear interpolations. 
-        */
-       case factor_5pt:
-         /* Is the raw value larger than the positive half scale? */
-         if ( rval > cal_ps->posHS )
-         {
-	    rng    = ref_rng_a[0];
-	    offset = offset_a[0]; /* absolute difference between -10 and +5 (full scale) */
-	    scale  = (double)(cal_ps->posFS - cal_ps->posHS);
-	    dval   = ((double)(rval - cal_ps->posHS) * (double)rng)/scale + (double)offset;
-         }
-         /* Is the raw value between zero and positive half scale? DOES NOT WORK! */
-         else if ((rval >= cal_ps->zero) && (rval <= cal_ps->posHS) )
-         {
-	    rng    = ref_rng_a[0];
-	    offset = offset_a[1]; /* absolute difference between -10 and 0 */
-            scale  = (double)(cal_ps->posHS - cal_ps->zero);
-            dval   = ((double)(rval - cal_ps->zero) * (double)rng)/scale + (double)offset;
-         }
-         /* Is the raw value between zero and nagative half scale? */
-         else if ((cal_ps->zero > rval) && ( rval >= cal_ps->negHS) )
-         {
-	   rng    = ref_rng_a[1];
-	   offset = offset_a[2]; /* absolute difference between 0 and +10 ((full scale) */
-           scale  = (double)(cal_ps->zero - cal_ps->negHS);
-	   dval   = ((double)(rval - cal_ps->zero) * (double)rng)/ scale + (double)offset;
-         }
-         /* Is the raw value less than nagative half scale? */
-         else if ( rval < cal_ps->negHS )
-         {
-	   rng    = ref_rng_a[1];
-	   offset = offset_a[3]; /* absolute difference between -5 and +10 (full scale)*/
-           scale  = (double)(cal_ps->negHS - cal_ps->negFS);
-           dval   = ((double)(rval - cal_ps->negHS) * (double)rng)/scale + (double)offset;
-         }
-         break;
- 
-        /*
-	 * Three point calibration with reference voltages at 
-	 * -10V, 0V and +10V. This givs us two linear interpolations. 
-         */
-        case factor_3pt: 
-        /* Is the raw value less nagative? */
-	rng = ref_rng_a[0];
-        if ( rval < cal_ps->zero )
-        {
-	   offset = offset_a[2]; /* difference between 0 and +10 (full scale)*/
-           scale  = (double)(cal_ps->zero - cal_ps->negFS);
-           dval   = ((double)(rval - cal_ps->negFS) * (double)rng)/scale  + (double)offset;
-        }
-        /* Is the raw value greater than or equal to zero? */
-        else
-        {
-	   offset = offset_a[1]; /* difference between 0 and -10 (full scale) */
-	   scale  = (double)(cal_ps->posFS - cal_ps->zero);
-           dval   = ((double)rval * (double)rng)/scale + (double)offset;
-        }
- 	break;
-
-  }/* End of switch statement */
- 
-  /* if necssary, clip calibrated value */
-  if(dval > (double)resol )
-    dval = resol;
-  else if( dval < 0)
-   dval = 0.0;
+  unsigned short                 i;
+  unsigned int                   val;
+  volatile unsigned int const   *src32_p;
+  HY8413_IO                      io_ps = (HY8413_IO)io_p;
 
-  return( (long)dval ); 
+  /* 
+   * Paired accesses need the register bank on a 4-byte boundary.
+   * The pair is stored as read, so the words stay in address order.
+   */
+  if ( d32 && !((unsigned long)io_ps->adc_a & 0x3) )
+  {
+    src32_p = (volatile unsigned int const *)io_ps->adc_a;
+    for (i=0; i<HY8413_ADC_NREG/2; i++)
+    {
+      val = src32_p[i];
+      memcpy( &val_a[2*i], &val, sizeof(val) );
+    }
+    return( HY8413_ADC_NREG/2 );
+  }
+  for (i=0; i<HY8413_NUM_CHAN; i++)
+    val_a[i] = io_ps->adc_a[i];
+  val_a[HY8413_ADC_REF0]  = io_ps->ref_zero_volt;
+  val_a[HY8413_ADC_REF25] = io_ps->ref_2_5_volt;
+  return( HY8413_ADC_NREG );
 }
 
 /*====================================================
@@ -596,7 +560,13 @@ long drvHy8413_cal_adc( unsigned short  const * const gain_a,
           Mech: By reference  
  
   Rem: This function reads calibration data from id prom
-       memory fro all channels.
+       memory fro all channels, for both voltage ranges, so
+       the range can be changed later without paging the id
+       prom. If the calibration cache has the data of this
+       module for a range, only the first page of the range
+       is read, to check the entry. Otherwise the data read
+       is saved in the cache, see
+       drvHy8413CalCache.c.
 
   Side: None
  
@@ -608,13 +578,15 @@ long drvHy8413_cal_adc( unsigned short  const * const gain_a,
 static long drvHy8413_rd_cal_data( hytec_ipmConfig_ts * const card_ps )
 {
    long                status = OK;   /* return status            */
+   long                rstatus;       /* status of a range        */
    unsigned short      page;          /* page index counter       */
    unsigned short      max;
+   unsigned short      range;         /* voltage range            */
    static const struct
    {
      unsigned short imin;
      unsigned short imax;
-   } page_as[2] = {{1,3,},{3,6}};
+   } page_as[NUM_RANGES] = {{1,3,},{4,6}};
   
  
    switch( card_ps->cal_s.type )
@@ -626,16 +598,30 @@ static long drvHy8413_rd_cal_data( hytec_ipmConfig_ts * const card_ps )
 
        case factor_3pt:
        case factor_5pt: 
-	  max = page_as[card_ps->range].imax;
-	  for (page = page_as[card_ps->range].imin && (status==OK);page <= max; page++ )
-	    status = drvHy8413_rd_cal_page( card_ps, page );
+          for (range=0; range<NUM_RANGES; range++)
+          {
+            if ( drvHy8413_cache_ld( card_ps, range ) == OK )
+            {
+              printf("drvHy8413: Calibration data of card %s range %hu read from cache\n",
+                     card_ps->name_c, range);
+              continue;
+            }
+            rstatus = OK;
+	    max = page_as[range].imax;
+	    for (page = page_as[range].imin; (page <= max) && (rstatus==OK); page++ )
+	      rstatus = drvHy8413_rd_cal_page( card_ps, page );
          
-          /*
-	   *  No matter what be sure to reset the
-	   *  id prom back to page zero before exiting
-           */
-          page = 0;
-          drvHy8413_wt_page( card_ps->io_p, page );
+            /*
+	     *  No matter what be sure to reset the
+	     *  id prom back to page zero before exiting
+             */
+            page = 0;
+            drvHy8413_wt_page( card_ps->io_p, page );
+            if ( rstatus==OK )
+              drvHy8413_cache_save( card_ps, range );
+            else
+              status = ERROR;
+          }
 	  break;
    }/* End of switch statement */
 
@@ -661,7 +647,8 @@ static long drvHy8413_rd_cal_data( hytec_ipmConfig_ts * const card_ps )
           Mech: By reference  
  
   Rem: This function reads calibration data from the
-       specified id prom page. This function sets the
+       specified id prom page into the calibration data of
+       the range the page belongs to. This function sets the
        id prom page in the auxilliary controlr register 
        and then reads the channel data. Upon return from
        this function, the id prom page number is NOT reset.
@@ -683,6 +670,7 @@ static long drvHy8413_rd_cal_page( hytec_ipmConfig_ts * const card_ps,
   unsigned short i_pts=0;                   /* num of calib points     */
   unsigned short i_chan=0;                  /* channel number          */
   unsigned short i=0;                       /* index counters          */
+  unsigned short range;                     /* voltage range of page   */
   unsigned short gain;                      /* gain value read from id */
   hytec_ipmCalChan_ts     *cal_ps=NULL;     /* local calibration info  */
   volatile unsigned short *id_a=NULL;
@@ -721,8 +709,9 @@ static long drvHy8413_rd_cal_page( hytec_ipmConfig_ts * const card_ps,
       if ((page % npages)==0) 
        nchan=HY8413_MIN_PG_CHAN;
      
-      /* calcuate first channel number on this page */
-      i_chan = (page-1)*HY8413_MAX_PG_CHAN;
+      /* calcuate range and first channel number on this page */
+      range  = (page-1)/npages;
+      i_chan = ((page-1)%npages)*HY8413_MAX_PG_CHAN;
       
       /* 
        * Read calibration data for all channels on this page.
@@ -744,18 +733,19 @@ static long drvHy8413_rd_cal_page( hytec_ipmConfig_ts * const card_ps,
         *        2     zero 0V
         *        3     pHS +5V
         *        4     pFS +10V
+        *
+        * The channels follow each other on the page.
         */ 
         id_a   = card_ps->id_pu->_a;
-        card_ps->cal_s.chan_as[i_chan].init = 1;
-        card_ps->cal_s.chan_as[i_chan].enb  = 1;
         cal_ps = &card_ps->cal_s.chan_as[i_chan];
+        cal_ps->rngInit |= 1 << range;
+        cal_ps->enb      = 1;
         if (debugHy8413)
           printf("\tCh: %hd",i_chan+i_pts);
-	for (i_pts=0, offset=0; i_pts<MAX_CAL_PTS; i_pts++,offset++)
+	for (i_pts=0, offset=i*MAX_CAL_PTS; i_pts<MAX_CAL_PTS; i_pts++,offset++)
         {
 	   gain = id_a[offset];
-	   cal_ps->gain_a[offset_binary][i_pts]   = gain;
-           cal_ps->gain_a[twos_compliment][i_pts] = gain & TWOS_COMPLIMENT_MAX;
+	   cal_ps->rng_a[range][i_pts] = gain;
            if (debugHy8413)
               printf("\t0x%hx",gain);
 	}
@@ -1009,7 +999,6 @@ short  drvHy8413_rd_clk_rate( volatile unsigned short  *  const  io_p)
 long drvHy8413_init_sam_mode( volatile unsigned short  *  const  io_p )
 {
   long           status  = OK;
-  unsigned short val     = 0;
   HY8413_IO      io_ps   = NULL;
  
   
@@ -1041,9 +1030,11 @@ long drvHy8413_init_sam_mode( volatile unsigned short  *  const  io_p )
   /* Next set the Control Status Register (CSR) to ARM the board */
   io_ps->csr |= HY8413_CSR_ARM;
 
-  /* Set the ADN/BUF bit and then check for a state change */
-  io_ps->csr |= HY8413_ACR_ADN;
-  val = io_ps->csr & HY8413_ACR_ADN;
+  /*
+   * ADN/BUF is an ACR bit that the firmware toggles on each
+   * buffer swap in SAM mode, there is nothing to set here. The
+   * averager watcher follows it, see drvHy8413Sam.c.
+   */
 
   /* 
    * Finally, set Auxiliary Control Register (ACR)
@@ -1054,6 +1045,48 @@ long drvHy8413_init_sam_mode( volatile unsigned short  *  const  io_p )
   return( status );
 }
 
+/*====================================================
+ 
+  Abs:  Initialize the averager in polling mode
+ 
+  Name: drvHy8413_init_ave_mode
+ 
+  Args: io_p                           Ptr to io memory
+          Type: address
+          Use:  volatile unsigned short * const
+          Acc:  read-write
+          Mech: By reference
+         
+  Rem: This function enables the averager with SAM
+       Readout Mode off. Each average is flagged by ADN
+       and must be acknowledged by writing ADN=1 before
+       the next one starts, see drvHy8413Sam.c. This mode
+       is only available in the SLAC modified version (v2).
+
+  Side: None
+ 
+  Ret:  long
+             OK    - Successful operation (always)
+ 
+=======================================================*/
+long drvHy8413_init_ave_mode( volatile unsigned short  *  const  io_p )
+{
+  HY8413_IO      io_ps   = (HY8413_IO)io_p;
+
+  /* Make sure the modules is not ARMed */
+  io_ps->csr &= ~HY8413_CSR_ARM;
+
+  /* Pulse AINI, then enable the averager with SAM mode off */
+  io_ps->acr |= HY8413_ACR_AINI;
+  io_ps->acr &= ~HY8413_ACR_AINI;
+  io_ps->acr &= ~(HY8413_ACR_SAM | HY8413_ACR_ADN);
+  io_ps->acr |= HY8413_ACR_AEN | HY8413_ACR_NS | HY8413_ACR_ARS;
+
+  /* ARM the board */
+  io_ps->csr |= HY8413_CSR_ARM;
+  return( OK );
+}
+
 
 /*====================================================
  
@@ -1144,6 +1177,68 @@ long drvHy8413_wt_acr( volatile unsigned short  *  const  io_p,
   return( status );
 }
 
+/*====================================================
+ 
+  Abs:  Write bits of the auxilary control register of a card
+ 
+  Name: drvHy8413_acr_wt
+ 
+  Args: card_p                        Card information
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference            
+
+        mask                          Bits to write
+          Type: bitmask                  
+          Use:  unsigned short                 
+          Acc:  read-only                
+          Mech: By value     
+
+        val                           State of the bits
+          Type: bitmask                  
+          Use:  unsigned short                 
+          Acc:  read-only                                     
+          Mech: By value     
+ 
+  Rem: This function sets the ACR bits in mask to their
+       state in val and leaves the others as read. Every
+       write of the ACR by a record goes through here, so
+       that the register shadow is refreshed and a range or
+       format change is followed by the calibration data of
+       the new range, the fixed-point segments and the
+       tables (see drvHy8413_cal_check).
+
+       Interrupts are locked across the read-modify-write,
+       so writes from records and the ADN acknowledge of the
+       averager watcher (see drvHy8413Sam.c) do not undo one
+       another. drvHy8413_cal_check() is only called when the
+       range or data format bits are in mask.
+
+  Side: The calibration lock is taken for a range or format
+        write.
+ 
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, see drvHy8413_cal_check()
+ 
+=======================================================*/
+long drvHy8413_acr_wt( void * const   card_p, 
+                       unsigned short mask,
+                       unsigned short val )
+{
+  int            key;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+ 
+  key = epicsInterruptLock();
+  io_ps->acr = (io_ps->acr & ~mask) | (val & mask);
+  epicsInterruptUnlock( key );
+  drvHy8413_snap_reg_touch( card_ps );
+  if ( !(mask & (HY8413_ACR_RGE | HY8413_ACR_2C)) ) return( OK );
+  return( drvHy8413_cal_check( card_ps ) );
+}
+
 
 /*====================================================
  
@@ -1255,6 +1350,7 @@ long drvHy8413_init( void * const card_p,unsigned long mask )
 
   /* Set the number of channels for an ip-adc-8413 module */
   card_ps->nchan = HY8413_NUM_CHAN;
+  card_ps->d32   = (mask & HY8413_MASK_D32) ? 1 : 0;
   
   /* Set the Auxiliary Control Register (ACR) to normal operating mode and offset binary */
   val = HY8413_ACR_NS | HY8413_ACR_2C;  
@@ -1274,8 +1370,14 @@ long drvHy8413_init( void * const card_p,unsigned long mask )
   /* read adc voltage range */
   card_ps->range = (val & HY8413_ACR_RGE) >> HY8413_ACR_RGE_SHFT;
 
-  /* Read the interrupt vector address */
-  card_ps->intVec = io_ps->vec; 
+  /* 
+   * Set the interrupt vector, if one was supplied.
+   * Otherwise, read the interrupt vector address.
+   */
+  if ( card_ps->intVec )
+    io_ps->vec = card_ps->intVec;
+  else
+    card_ps->intVec = io_ps->vec; 
 
   /* 
    * Read calibration type and then read calibration data from id prom 
@@ -1284,13 +1386,23 @@ long drvHy8413_init( void * const card_p,unsigned long mask )
   status = drvHy8413_rd_cal_type( card_ps->id_pu->_a, &card_ps->cal_s );
   if ( status == OK )
     status = drvHy8413_rd_cal_data( card_ps );
+
+  /* Calibration data of the range in use, and its fixed-point segments */
+  if ( status == OK )
+    drvHy8413_cal_range( card_ps );
   
   /* Set anything special for the init */
   if ( (status == OK) && mask ) {
-     val = (mask >>16) & HY8413_CLK_RATE_MASK;
+     val = (mask >> HY8413_MASK_CLK_SHFT) & HY8413_CLK_RATE_MASK;
      status = drvHy8413_wt_clk_rate( card_ps->io_p,val );
-     if ((status==OK) && (mask && 1))
+     if ((status==OK) && (mask & HY8413_MASK_SAM))
        status = drvHy8413_init_sam_mode( card_ps->io_p );
+     else if ((status==OK) && (mask & HY8413_MASK_AVE))
+       status = drvHy8413_init_ave_mode( card_ps->io_p );
+     if ((status==OK) && (mask & HY8413_MASK_INT))
+       status = drvHy8413_fifo_init( card_ps,mask );
+     if ((status==OK) && (mask & HY8413_MASK_LUT))
+       drvHy8413_cal_lut_build( card_ps );
   }      
     
   /* flag init complete */
@@ -1299,7 +1411,12 @@ long drvHy8413_init( void * const card_p,unsigned long mask )
       printf("drvHy8413: Successfully initalized card %s\n",card_ps->name_c);
   }
   else 
+  {
+     /* Nothing may run on a card that failed, see drvHy8413_fifo_stop() */
+     if ( card_ps->fifo_s.tid || card_ps->intHandler )
+       drvHy8413_fifo_stop( card_ps );
      printf("drvHy8413: Failed to initalize card %s\n",card_ps->name_c);
+  }
 
   return( status );
 }
@@ -1373,6 +1490,108 @@ long ip8413Create(char const * const name_c,
   return( status );
 }   
 
+/*====================================================
+
+  Abs:  Benchmark single and block register reads
+
+  Name: ip8413RdBench
+
+  Args: name_c                          Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        nloop                           Number of passes
+          Type: integer                 Note: default 10000
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function reads the 16 channels and both
+        references of a card nloop times, one drvHy8413_rd()
+        call per register as read_ai does, then with the block
+        read using 16-bit accesses and, if the carrier allows
+        it (HY8413_MASK_D32), 32-bit accesses. The time and the
+        number of bus cycles per pass of each are displayed.
+        The references read by the 16 and 32-bit block reads
+        are compared. The 32-bit pass is skipped on a carrier
+        that does not allow it, since it may bus error.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - Successful
+             ERROR - Card not found or references differ
+
+=======================================================*/
+long ip8413RdBench( char const * const name_c, int nloop )
+{
+  long             status = OK;
+  int              i;
+  int              k;
+  int              nk;
+  long             ncyc_a[3];
+  double           dt_a[3];
+  short            val;
+  unsigned short   c;
+  unsigned short   d16_a[HY8413_ADC_NREG];
+  unsigned short   d32_a[HY8413_ADC_NREG];
+  epicsTimeStamp   t0,t1;
+  HY8413_IO        io_ps   = NULL;
+  IPADC_ID         card_ps = NULL;
+  static const char *name_ac[3] = {"drvHy8413_rd","block D16","block D32"};
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( nloop <= 0 ) nloop = 10000;
+  io_ps = (HY8413_IO)card_ps->io_p;
+
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+  {
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+      drvHy8413_rd( card_ps->io_p, c, &val );
+    val = io_ps->ref_zero_volt;
+    val = io_ps->ref_2_5_volt;
+  }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[0]   = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+  ncyc_a[0] = HY8413_ADC_NREG;
+
+  nk = card_ps->d32 ? 2 : 1;
+  for (k=0; k<nk; k++)
+  {
+    epicsTimeGetCurrent( &t0 );
+    for (i=0; i<nloop; i++)
+      ncyc_a[k+1] = drvHy8413_rd_block( card_ps->io_p, k, k ? d32_a : d16_a );
+    epicsTimeGetCurrent( &t1 );
+    dt_a[k+1] = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+  }
+
+  printf("IP8413 %s register read, %d passes, carrier D32 %s\n",
+         name_c, nloop, card_ps->d32 ? "allowed" : "not allowed, D32 pass skipped" );
+  for (k=0; k<=nk; k++)
+    printf("\t%-14s: %8.3f us  %2ld bus cycles per pass\n",
+           name_ac[k], dt_a[k]*1.0e6, ncyc_a[k] );
+
+  /* The references do not change between passes */
+  if ( card_ps->d32 &&
+       ((d16_a[HY8413_ADC_REF0]  != d32_a[HY8413_ADC_REF0]) ||
+        (d16_a[HY8413_ADC_REF25] != d32_a[HY8413_ADC_REF25])) )
+  {
+     printf("\tFAILED: references differ D16 0x%04hx 0x%04hx  D32 0x%04hx 0x%04hx\n",
+            d16_a[HY8413_ADC_REF0], d16_a[HY8413_ADC_REF25],
+            d32_a[HY8413_ADC_REF0], d32_a[HY8413_ADC_REF25] );
+     status = ERROR;
+  }
+  return( status );
+}
+
 
 
 
@@ -6,6 +6,7 @@
   Name: drvHy8413.h
 
   Side: Must included the following header files
+             epicsVersion.h - for HY8413_RMB/WMB
              callback.h - for CALLBACK
              dbScan.h   - for IOSCANPVT
              devLib.h   - for epicsAddressType
@@ -23,6 +24,10 @@
 #ifndef DRVHY8413_H
 #define DRVHY8413_H
 
+#if (EPICS_VERSION == 7) || (EPICS_REVISION >= 15)
+#include "epicsAtomic.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
@@ -38,23 +43,80 @@ extern "C" {
 #define ICNT(err)     ( err==0xffff ? err=1 : err++ )
 #define MIN(a,b)      ( a<b ? a : b )
 
+/*
+ * Memory barriers for data shared with lock-free readers
+ * (sample ring, calibration tables). epicsAtomic is
+ * available from 3.15, before that use the compiler builtin.
+ */
+#if (EPICS_VERSION == 7) || (EPICS_REVISION >= 15)
+#define HY8413_RMB()   epicsAtomicReadMemoryBarrier()
+#define HY8413_WMB()   epicsAtomicWriteMemoryBarrier()
+#else
+#define HY8413_RMB()   __sync_synchronize()
+#define HY8413_WMB()   __sync_synchronize()
+#endif
+
 /********************************************
 
               Task information
 
 *********************************************/
 
-/* IO scan task */
+/* IO scan task. One per averaging card, watches the BUF or ADN bit */
 #define HY8413_SCAN_NAME      "Hy8413Scan"
 #define HY8413_SCAN_PRI       70
 #define HY8413_SCAN_OPT       FP_TASK
-#define HY8413_SCAN_STACK     (4096 * ARCH_STACK_FACTOR)
+#define HY8413_SCAN_STACK     epicsThreadGetStackSize(epicsThreadStackSmall)
 
-/* Fifo full task.  */
+/* Fifo full task. One per card, drains the external FIFO */
 #define HY8413_DONE_NAME      "Hy8413Done"
 #define HY8413_DONE_PRI       69
 #define HY8413_DONE_OPT       FP_TASK
-#define HY8413_DONE_STACK     (4096 * ARCH_STACK_FACTOR)
+#define HY8413_DONE_STACK     epicsThreadGetStackSize(epicsThreadStackMedium)
+
+/* Calibration table task. One per card using tables, rebuilds them off the record thread */
+#define HY8413_CAL_NAME       "Hy8413Cal"
+#define HY8413_CAL_PRI        20
+#define HY8413_CAL_OPT        FP_TASK
+#define HY8413_CAL_STACK      epicsThreadGetStackSize(epicsThreadStackSmall)
+
+/* Drift correction task. One per card when enabled, tracks the references */
+#define HY8413_DRIFT_NAME     "Hy8413Drift"
+#define HY8413_DRIFT_PRI      20
+#define HY8413_DRIFT_OPT      FP_TASK
+#define HY8413_DRIFT_STACK    epicsThreadGetStackSize(epicsThreadStackSmall)
+#define HY8413_DRIFT_PERIOD   1.0    /* reference sampling period (sec)      */
+#define HY8413_DRIFT_MAXSHFT  12     /* smallest ema weight 2^-12            */
+#define HY8413_DRIFT_MAXGAIN  0.02   /* largest gain trim accepted, relative */
+#define HY8413_DRIFT_MINSPAN  1000.0 /* smallest 0 to 2.5V span (counts)     */
+#define HY8413_DRIFT_DEADBAND 1.5    /* smallest point move applied (counts) */
+
+/************************************************************
+
+                  Module Setup Bitmask
+          (mask argument of ip8413Create())
+
+*************************************************************/
+
+/*
+ *  Bit(s)  Description
+ *  ------  -----------------------------------------------
+ *    0     Initialize the module in SAM Readout Mode (v2 only)
+ *    1     Interrupt driven external FIFO readout
+ *    2     Carrier allows 32-bit (D32) accesses to the io space
+ *    3     Initialize the averager in polling mode, SAM off (v2 only)
+ *    4     Build calibration tables (128 kbytes per calibrated channel)
+ *   8-10   Interrupt level (0 = use DEFAULT_INT_LEVEL)
+ *  16-19   Clock rate (0-15), applied when mask is non-zero
+ */
+#define HY8413_MASK_SAM        0x00000001
+#define HY8413_MASK_INT        0x00000002
+#define HY8413_MASK_D32        0x00000004
+#define HY8413_MASK_AVE        0x00000008
+#define HY8413_MASK_LUT        0x00000010
+#define HY8413_MASK_LVL        0x00000700
+#define HY8413_MASK_LVL_SHFT   8
+#define HY8413_MASK_CLK_SHFT   16
 
 /************************************************************
 
@@ -266,6 +328,13 @@ typedef enum {
  */
 #define HY8413_CSR_ARM      0x8000  
 
+/* 
+ * Interrupt enables used by the FIFO drain engine. Although the
+ * EHF description above refers to the pre-trigger FIFO, the half
+ * full interrupt pairs with the post-trigger THF status bit.
+ */
+#define HY8413_CSR_INT_MASK  (HY8413_CSR_EHF | HY8413_CSR_ETF)
+
 /************************************************************
 
              Auxilary Control Register bit masks (ACR)
@@ -340,7 +409,10 @@ typedef enum
 
 #define TWOS_COMPLIMENT_MIN     0x8000
 #define TWOS_COMPLIMENT_ZERO    0x0
-#define TWOS_COMPLIMENT_MAX     0x7fff		    
+#define TWOS_COMPLIMENT_MAX     0x7fff
+
+/* xor mask to convert between two's complement and offset binary */
+#define HY8413_2C_FLIP          0x8000		    
 /*  
  * Paging:
  * Bit 0 of ID PROM Paging
@@ -373,6 +445,7 @@ typedef enum
  */
 #define HY8413_ACR_AEN       0x0080 
 #define HY8413_ACR_AEN_SHFT   7
+#define HY8413_AVE_NSAMP     64    /* samples per average */
 
 /*
  * ADN/BUF (A/B): Bit 8
@@ -476,6 +549,83 @@ typedef enum
 #define HY8413_NUM_CHAN        16           /* total number of channels     */
 #define HY8413_MAX_CHAN        15          /* maximum signal (chan) number */
 #define HY8413_FIFO_BCNT      (1024*256)   /* 256K fifo length             */
+#define HY8413_FIFO_NGRP      (HY8413_FIFO_BCNT/HY8413_NUM_CHAN) /* 16384 sample groups */
+#define HY8413_PRE_BCNT       16           /* pre-trigger fifo length      */
+#define HY8413_PRE_NGRP       (HY8413_PRE_BCNT/HY8413_NUM_CHAN)  /* 1 sample group */
+#define HY8413_WF_NELM        (HY8413_FIFO_NGRP+HY8413_PRE_NGRP) /* samples per pool buffer */
+#define HY8413_WF_NBUF        MAX_WF_BUF       /* buffers in pool, 2 captures  */
+#define HY8413_ADC_NREG       (HY8413_NUM_CHAN+2) /* adc_a and both references   */
+#define HY8413_ADC_REF0       HY8413_NUM_CHAN     /* ref_zero_volt in block read */
+#define HY8413_ADC_REF25      (HY8413_NUM_CHAN+1) /* ref_2_5_volt in block read  */
+#define HY8413_DMA_MIN_WORDS  (HY8413_NUM_CHAN*16) /* shorter runs use programmed I/O */
+#define HY8413_SNAP_MAXAGE    0.1          /* oldest snapshot served (sec) */
+#define HY8413_REG_ACR        0            /* acr in the register shadow   */
+#define HY8413_REG_CSR        1            /* csr in the register shadow   */
+#define HY8413_REG_MAXAGE     0.1          /* oldest shadow served (sec)   */
+#define HY8413_CAL_LUT_NELM   65536        /* calibration table entries    */
+
+/*
+ * Software filters on the averager output, see drvHy8413Filt.c
+ * (filt_as in hytecIpm.h)
+ */
+typedef enum
+{
+   filt_none   = 0,  /* no filter                              */
+   filt_boxcar = 1,  /* mean of the last N averages            */
+   filt_ema    = 2   /* exponential moving average, weight 2^-N */
+} hy8413_filt_te;
+
+#define HY8413_FILT_NTYPE    3
+#define HY8413_FILT_MAXN     256   /* longest boxcar, in averages      */
+#define HY8413_FILT_MAXSHFT  12    /* smallest ema weight 2^-12        */
+#define HY8413_FILT_FRAC     8     /* fraction bits of filter output   */
+#define HY8413_FILT_EMAFRAC  14    /* fraction bits of the ema state   */
+
+/*
+ * External FIFO acquisition state, as kept in the
+ * card configuration (see fifo_s in hytecIpm.h)
+ */
+typedef enum
+{
+   fifo_idle  = 0,   /* not armed                          */
+   fifo_armed = 1,   /* armed, waiting for trigger or data */
+   fifo_done  = 2    /* capture complete, data in buffer   */
+}hy8413_fifoState_te;
+
+/*
+ * External FIFO acquisition mode
+ */
+typedef enum
+{
+   acq_capture = 0,  /* one FIFO of samples per trigger           */
+   acq_stream  = 1,  /* read while filling, for a number of       */
+                     /* sample groups or continuously into a ring */
+   acq_pretrig = 2,  /* capture preceded by the pre-trigger FIFO  */
+   acq_segment = 3,  /* short captures of many triggers per arm   */
+   acq_soft    = 4   /* short capture on a software trigger (ST)  */
+}hy8413_acqMode_te;
+#define HY8413_ACQ_NMODE     5
+#define HY8413_SOFT_NGRP     1024  /* default software trigger capture */
+
+/*
+ * External FIFO status items, selected by the channel
+ * field of a longin record INP "@card:item:DATA"
+ */
+typedef enum
+{
+   fifo_item_trig = 0,  /* trigger sample number (32-bit)           */
+   fifo_item_npre = 1,  /* pre-trigger sample groups in capture     */
+   fifo_item_ngrp = 2,  /* sample groups captured since armed       */
+   fifo_item_nseg = 3,  /* segments completed since armed           */
+   fifo_item_seq  = 4,  /* sequence number of the next group (lsw)  */
+   fifo_item_lost = 5,  /* sample groups lost since armed (lsw)     */
+   fifo_item_ovf  = 6,  /* FIFO overflows seen (old_data)           */
+   fifo_item_gap  = 7,  /* sequence gaps seen (inv_data)            */
+   fifo_item_tmo  = 8,  /* streaming polls without data (tmo)       */
+   fifo_item_seqh = 9,  /* sequence number of the next group (msw)  */
+   fifo_item_losth= 10  /* sample groups lost since armed (msw)     */
+}hy8413_fifoItem_te;
+#define HY8413_FIFO_NITEM    11
 
 /* 
  * The adc register readout has 16 buffer registers (from base+0x10 to base+0x2e),
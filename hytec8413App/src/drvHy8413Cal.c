@@ -0,0 +1,2066 @@
+/*
+=============================================================
+
+  Abs:  Calibration tables for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Cal.c
+             drvHy8413_cal_adc       - calibrate raw adc data
+             drvHy8413_cal_val       - Calibrate a raw value of a channel
+             drvHy8413_cal_lut_build - Build the calibration tables of a card
+          *  drvHy8413_cal_lut_task  - Rebuild the calibration tables after a change
+          *  drvHy8413_cal_seg       - Set up one fixed-point calibration segment
+             drvHy8413_cal_fix_set   - Set up the fixed-point calibration of a channel
+             drvHy8413_cal_fix_build - Set up the fixed-point calibration of a card
+          *  drvHy8413_cal_eval      - Evaluate a fixed-point calibration segment
+             drvHy8413_cal_fix       - Calibrate a raw value in fixed point
+          *  drvHy8413_cal_run       - Calibrate a strided block of one channel
+             drvHy8413_cal_chan_blk  - Calibrate a block of samples of one channel
+             drvHy8413_cal_grp_blk   - Calibrate a block of 16-channel groups
+             drvHy8413_cal_egu_set   - Fold the calibration of a channel into EGU coefficients
+             drvHy8413_cal_egu       - Convert a raw value of a channel to EGU
+          *  drvHy8413_cal_trim_pt   - Trim one calibration point
+             drvHy8413_cal_range     - Select the calibration data of the range in use
+             drvHy8413_cal_trim      - Trim the calibration points for drift
+             drvHy8413_cal_check     - Follow a range or format change
+             drvHy8413_cal_report    - Display calibration table information
+             ip8413CalLut            - Build or drop the calibration tables (shell)
+             ip8413CalFix            - Use or drop the fixed-point calibration (shell)
+             ip8413CalFixTest        - Check and time the fixed-point calibration (shell)
+             ip8413CalBlkBench       - Check and time the block calibration (shell)
+
+          * indicates static routines
+
+  Rem:  drvHy8413_cal_adc() works out the calibration of a raw
+        value with a switch, several comparisons and double
+        precision divides. Optionally, each calibrated channel
+        gets a table of all 65536 calibrated values, built once
+        from the id prom calibration data for the data format and
+        range in use, and calibration is a single indexed load.
+
+        The tables take 128 kbytes per calibrated channel. They
+        are built at init when bit 4 of the ip8413Create() mask
+        is set, or later with ip8413CalLut(). They are rebuilt
+        when the range or format of the card is changed through
+        the ACR, by a low priority task of the card rather than
+        by the record that wrote the ACR, and when the drift trim
+        moves a calibration point. Readers do not lock. Each
+        table is built into a spare and the pointer swapped in,
+        so that after a trim the previous tables, still good to
+        within a count, stay in use until the new ones are in.
+        After a range or format change the previous tables are
+        wrong, so they are withdrawn and the readers fall back
+        to drvHy8413_cal_adc() until the new ones are in. The
+        spare doubles the memory of a card that rebuilds its
+        tables in use.
+
+        The fixed-point calibration needs only a few hundred
+        bytes per card. drvHy8413_cal_adc() maps each segment
+        between calibration points linearly,
+
+            offset + (raw - base) * rng / scale
+
+        truncated and clipped to 0..65535. Each segment keeps
+        rng/scale as a Q32 magnitude rounded up and rounded down.
+        With |raw - base| < 2^16 and |scale| < 2^16 the product
+        error stays below 1/|scale|, the smallest non-zero
+        fraction of the exact result, so rounding the product
+        down with the rounded up slope (or up with the rounded
+        down slope for a decreasing result) gives the same value
+        as the double precision path, with integer multiply and
+        shift only. A Q16 slope is not precise enough for that.
+        ip8413CalFixTest() checks it over all 65536 inputs.
+
+        The segments are set up at init for every calibrated
+        card, whether or not drvHy8413_cal_val() uses them, for
+        the block calibration: drvHy8413_cal_chan_blk() and
+        drvHy8413_cal_grp_blk() calibrate a whole block of one
+        channel, or of 16-channel groups as read from the FIFO
+        or the snapshot, in one call. The calibration type and
+        enables are checked once per channel instead of once per
+        sample, and when the breakpoints are in order the
+        segment is picked by summing comparisons rather than by
+        a chain of tests. The result is the same as
+        drvHy8413_cal_val(). ip8413CalBlkBench() times it.
+
+        drvHy8413_cal_adc() lives here with the faster paths, so
+        that this file and drvHy8413CalBench.c build without the
+        rest of the driver, as the host test in ../tests does.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        17-Oct-2026, agent            (AGENT):
+           Move drvHy8413_cal_adc here from drvHy8413.c
+        17-Oct-2026, agent            (AGENT):
+           Scale both 3-point segments of drvHy8413_cal_adc from zero
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "cantProceed.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/* Segment constants, as in drvHy8413_cal_adc() */
+#define HY8413_CAL_RNG_POS   0x3ff8
+#define HY8413_CAL_RNG_NEG   0x3ff9
+#define HY8413_CAL_RNG3_POS  (2*HY8413_CAL_RNG_POS)  /* 3-point, zero to full scale */
+#define HY8413_CAL_RNG3_NEG  (2*HY8413_CAL_RNG_NEG)
+static const long offset_a[4] = {0xbff8, 0x7fff, 0x8000, 0x4007};
+
+/* Local Prototypes */
+static void drvHy8413_cal_seg( hytec_ipmCalSeg_ts * const seg_ps,
+                               long                       base,
+                               long                       rng,
+                               long                       scale,
+                               long                       offset );
+static long drvHy8413_cal_eval( hytec_ipmCalSeg_ts const * const seg_ps,
+                                long                             rval );
+static long drvHy8413_cal_run( IPADC_ID                     card_ps,
+                               unsigned short               chan,
+                               unsigned short const       * src_a,
+                               unsigned short             * dst_a,
+                               unsigned long                n,
+                               unsigned short               inc );
+static unsigned short drvHy8413_cal_trim_pt( IPADC_ID       card_ps,
+                                             unsigned short val );
+static void drvHy8413_cal_lut_task( void *card_p );
+
+
+/*====================================================
+ 
+  Abs:  Calculate adc value using calibration data
+ 
+  Name: drvHy8413_cal_adc
+ 
+  Args: gain_a                          Gain values 
+          Type: array                   Note: 5 element.
+          Use:  unsigned short const * const           
+          Acc:  read-only               
+          Mech: By reference            
+ 
+        calType                         Calibration type  
+          Type: integer                 Note: none
+          Use:  unsigned short                1 = 3-point
+          Acc:  read-only                     2 = 5-point
+          Mech: By value
+
+        format                          Data format  
+          Type: integer                 Note: 1=offste binary
+          Use:  unsigned short                0=two's compliment
+          Acc:  read-only
+          Mech: By value
+
+        rval                             Raw data value
+          Type: integer                  
+          Use:  long               
+          Acc:  read-only                
+          Mech: By value                      
+ 
+ 
+  Rem: This function calibrates the raw adc value 
+       supplied as an input argument. 
+
+  Side: None
+ 
+  Ret:  long 
+             calibrated 32-bit value
+ 
+=======================================================*/ 
+long drvHy8413_cal_adc( unsigned short  const * const gain_a,
+                        unsigned short                calType,
+                        unsigned short                format,
+                        long                          rval )
+{
+     hy8413_calData_ts *cal_ps = (hy8413_calData_ts *)gain_a;
+     double             scale=0.0;
+     double             dval=0.0;
+     long               offset=0;
+     long               resol=65535;
+     long               rng=0;
+ /*  long               zero_a[2]={TWOS_COMPLIMENT_ZERO,OFFSET_BINARY_ZERO}; */
+     long               ref_rng_a[2]={0x3ff8,0x3ff9};
+     long               offset_a[4]= {0xbff8,  /* -15V in counts remaining, from -10 to +5V  */
+                                      0x7fff,  /* -10V in counts remaining, from -10 to  0V  */
+                                      0x8000,  /* +10V in counts remaining, from   0 to +10V */
+                                      0x4007}; /* +15V in counts remaining, from +10 to -5V  */
+                                     
+     switch(calType) 
+     {
+       /* 
+	* Five point calibration with reference voltages at
+	* -10V, -5V, 0V, +5V and +10V.
+        * This gives us four linear interpolations. 
+        */
+       case factor_5pt:
+         /* Is the raw value larger than the positive half scale? */
+         if ( rval > cal_ps->posHS )
+         {
+	    rng    = ref_rng_a[0];
+	    offset = offset_a[0]; /* absolute difference between -10 and +5 (full scale) */
+	    scale  = (double)(cal_ps->posFS - cal_ps->posHS);
+	    dval   = ((double)(rval - cal_ps->posHS) * (double)rng)/scale + (double)offset;
+         }
+         /* Is the raw value between zero and positive half scale? */
+         else if ((rval >= cal_ps->zero) && (rval <= cal_ps->posHS) )
+         {
+	    rng    = ref_rng_a[0];
+	    offset = offset_a[1]; /* absolute difference between -10 and 0 */
+            scale  = (double)(cal_ps->posHS - cal_ps->zero);
+            dval   = ((double)(rval - cal_ps->zero) * (double)rng)/scale + (double)offset;
+         }
+         /* Is the raw value between zero and nagative half scale? */
+         else if ((cal_ps->zero > rval) && ( rval >= cal_ps->negHS) )
+         {
+	   rng    = ref_rng_a[1];
+	   offset = offset_a[2]; /* absolute difference between 0 and +10 ((full scale) */
+           scale  = (double)(cal_ps->zero - cal_ps->negHS);
+	   dval   = ((double)(rval - cal_ps->zero) * (double)rng)/ scale + (double)offset;
+         }
+         /* Is the raw value less than nagative half scale? */
+         else if ( rval < cal_ps->negHS )
+         {
+	   rng    = ref_rng_a[1];
+	   offset = offset_a[3]; /* absolute difference between -5 and +10 (full scale)*/
+           scale  = (double)(cal_ps->negHS - cal_ps->negFS);
+           dval   = ((double)(rval - cal_ps->negHS) * (double)rng)/scale + (double)offset;
+         }
+         break;
+ 
+        /*
+	 * Three point calibration with reference voltages at 
+	 * -10V, 0V and +10V. This givs us two linear interpolations. 
+         */
+        case factor_3pt: 
+        /* 
+         * Is the raw value less nagative? Each segment spans
+         * zero to full scale, twice the 5-point reference range.
+         */
+        if ( rval < cal_ps->zero )
+        {
+	   rng    = 2*ref_rng_a[1];
+	   offset = offset_a[2]; /* difference between 0 and +10 (full scale)*/
+           scale  = (double)(cal_ps->zero - cal_ps->negFS);
+           dval   = ((double)(rval - cal_ps->zero) * (double)rng)/scale  + (double)offset;
+        }
+        /* Is the raw value greater than or equal to zero? */
+        else
+        {
+	   rng    = 2*ref_rng_a[0];
+	   offset = offset_a[1]; /* difference between 0 and -10 (full scale) */
+	   scale  = (double)(cal_ps->posFS - cal_ps->zero);
+           dval   = ((double)(rval - cal_ps->zero) * (double)rng)/scale + (double)offset;
+        }
+ 	break;
+
+  }/* End of switch statement */
+ 
+  /* if necssary, clip calibrated value */
+  if(dval > (double)resol )
+    dval = resol;
+  else if( dval < 0)
+   dval = 0.0;
+
+  return( (long)dval ); 
+}
+
+/*====================================================
+
+  Abs:  Calibrate a raw value of a channel
+
+  Name: drvHy8413_cal_val
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        rval                            Raw data value
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function returns the calibrated value of a raw
+       sample, from the channel table when the tables are in
+       use, then from the fixed-point segments when in use,
+       otherwise from drvHy8413_cal_adc(). The caller
+       checks that calibration is enabled for the channel.
+
+  Side: None
+
+  Ret:  long
+             calibrated value, 0 to 65535
+
+=======================================================*/
+long drvHy8413_cal_val( void const * const card_p,
+                        unsigned short     chan,
+                        unsigned short     rval )
+{
+  unsigned short const *lut_a;
+  IPADC_ID              card_ps = (IPADC_ID)card_p;
+  hytec_ipmCalChan_ts  *cal_ps  = &card_ps->cal_s.chan_as[chan];
+
+  if ( card_ps->cal_s.lut )
+  {
+    HY8413_RMB();
+    lut_a = card_ps->cal_s.lut_a[chan];
+    if ( lut_a ) return( lut_a[rval] );
+  }
+  if ( card_ps->cal_s.fix && card_ps->cal_s.fixSet )
+  {
+    HY8413_RMB();
+    return( drvHy8413_cal_fix( &card_ps->cal_s.fix_as[chan], card_ps->cal_s.type, rval ) );
+  }
+  return( drvHy8413_cal_adc( &cal_ps->gain_a[card_ps->format][0],
+                             card_ps->cal_s.type,
+                             card_ps->format,
+                             rval ) );
+}
+
+/*====================================================
+
+  Abs:  Build the calibration tables of a card
+
+  Name: drvHy8413_cal_lut_build
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function fills the table of each channel with
+       calibration data by calling drvHy8413_cal_adc() for
+       every raw value, with the data format and range of
+       the card. Tables are allocated the first time.
+
+       When the tables in use were built for the same format
+       and range, as after a drift trim, each new table is
+       filled in the spare of its channel and then swapped
+       with the one in use, so that readers never see a table
+       half filled and never fall back meanwhile. The table
+       swapped out becomes the spare, a reader that loaded it
+       just before the swap is done with it long before the
+       next rebuild fills it. Otherwise the tables are
+       withdrawn from the readers and filled in place.
+
+  Side: Takes about a million drvHy8413_cal_adc() calls on
+        a fully calibrated card. The caller holds the
+        calibration lock, if the card has one.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - No calibration data on the card
+
+=======================================================*/
+long drvHy8413_cal_lut_build( void * const card_p )
+{
+  unsigned short       c;
+  unsigned short       swap;
+  unsigned long        rval;
+  unsigned short      *lut_a;
+  unsigned short      *in_a;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+
+  if ( card_ps->cal_s.type == nocal ) return( ERROR );
+
+  swap = card_ps->cal_s.lut &&
+         (card_ps->cal_s.lutFormat == card_ps->format) &&
+         (card_ps->cal_s.lutRange  == card_ps->range);
+  if ( !swap )
+  {
+    card_ps->cal_s.lut = 0;
+    HY8413_WMB();
+  }
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    if ( !cal_ps->init ) continue;
+
+    in_a  = card_ps->cal_s.lut_a[c];
+    lut_a = (swap && in_a) ? card_ps->cal_s.lutNext_a[c] : in_a;
+    if ( !lut_a )
+    {
+      lut_a = callocMustSucceed( HY8413_CAL_LUT_NELM,
+                                 sizeof(unsigned short),
+                                 "drvHy8413_cal_lut_build()" );
+      card_ps->cal_s.lutBytes += HY8413_CAL_LUT_NELM * sizeof(unsigned short);
+    }
+    for (rval=0; rval<HY8413_CAL_LUT_NELM; rval++)
+      lut_a[rval] = (unsigned short)drvHy8413_cal_adc( &cal_ps->gain_a[card_ps->format][0],
+                                                       card_ps->cal_s.type,
+                                                       card_ps->format,
+                                                       (long)rval );
+    HY8413_WMB();
+    card_ps->cal_s.lut_a[c] = lut_a;
+    if ( swap && in_a ) card_ps->cal_s.lutNext_a[c] = in_a;
+  }
+  card_ps->cal_s.lutFormat = card_ps->format;
+  card_ps->cal_s.lutRange  = card_ps->range;
+  card_ps->cal_s.nbuild++;
+  HY8413_WMB();
+  card_ps->cal_s.lut = 1;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Set up one fixed-point calibration segment
+
+  Name: drvHy8413_cal_seg
+
+  Args: seg_ps                          Segment
+          Type: pointer
+          Use:  hytec_ipmCalSeg_ts * const
+          Acc:  write-only
+          Mech: By reference
+
+        base                            Raw value at the origin
+          Type: integer
+          Use:  long
+          Acc:  read-only
+          Mech: By value
+
+        rng                             Reference range (counts)
+          Type: integer
+          Use:  long
+          Acc:  read-only
+          Mech: By value
+
+        scale                           Raw span of the segment
+          Type: integer                 Note: any sign, may be 0
+          Use:  long
+          Acc:  read-only
+          Mech: By value
+
+        offset                          Calibrated value at origin
+          Type: integer
+          Use:  long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function stores the slope rng/scale of a segment
+       as a Q32 magnitude, rounded up and down, and its sign.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_cal_seg( hytec_ipmCalSeg_ts * const seg_ps,
+                               long                       base,
+                               long                       rng,
+                               long                       scale,
+                               long                       offset )
+{
+  unsigned long long num = (unsigned long long)rng << 32;
+  unsigned long long den;
+
+  seg_ps->base   = base;
+  seg_ps->offset = offset;
+  seg_ps->sign   = (scale > 0) ? 1 : ((scale < 0) ? -1 : 0);
+  seg_ps->mc     = 0;
+  seg_ps->mf     = 0;
+  if ( !seg_ps->sign ) return;
+
+  den        = (scale > 0) ? scale : -scale;
+  seg_ps->mf = num/den;
+  seg_ps->mc = seg_ps->mf + ((num % den) ? 1 : 0);
+  return;
+}
+
+/*====================================================
+
+  Abs:  Set up the fixed-point calibration of a channel
+
+  Name: drvHy8413_cal_fix_set
+
+  Args: fix_ps                          Fixed-point calibration
+          Type: pointer
+          Use:  hytec_ipmCalFix_ts * const
+          Acc:  write-only
+          Mech: By reference
+
+        gain_a                          Calibration points
+          Type: array                   Note: 5 elements, for
+          Use:  unsigned short const *        one data format
+          Acc:  read-only
+          Mech: By reference
+
+        calType                         Calibration type
+          Type: integer                 Note: 1 = 3-point
+          Use:  unsigned short                2 = 5-point
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function sets up the segments that
+       drvHy8413_cal_adc() would use for these calibration
+       points, in the same order as its tests. The 5-point
+       breakpoints are flagged as ordered when the segment can
+       be picked by counting the breakpoints above the raw
+       value, the 3-point ones always are.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_cal_fix_set( hytec_ipmCalFix_ts   * const fix_ps,
+                            unsigned short const * const gain_a,
+                            unsigned short               calType )
+{
+  hy8413_calData_ts const *cal_ps = (hy8413_calData_ts const *)gain_a;
+
+  memset( fix_ps, 0, sizeof(*fix_ps) );
+  fix_ps->negHS = cal_ps->negHS;
+  fix_ps->zero  = cal_ps->zero;
+  fix_ps->posHS = cal_ps->posHS;
+  fix_ps->ordered = (calType != factor_5pt) ||
+                    ((cal_ps->negHS <= cal_ps->zero) && (cal_ps->zero <= cal_ps->posHS));
+  switch( calType )
+  {
+    case factor_5pt:
+      drvHy8413_cal_seg( &fix_ps->seg_as[0], cal_ps->posHS, HY8413_CAL_RNG_POS,
+                         (long)cal_ps->posFS - cal_ps->posHS, offset_a[0] );
+      drvHy8413_cal_seg( &fix_ps->seg_as[1], cal_ps->zero,  HY8413_CAL_RNG_POS,
+                         (long)cal_ps->posHS - cal_ps->zero,  offset_a[1] );
+      drvHy8413_cal_seg( &fix_ps->seg_as[2], cal_ps->zero,  HY8413_CAL_RNG_NEG,
+                         (long)cal_ps->zero  - cal_ps->negHS, offset_a[2] );
+      drvHy8413_cal_seg( &fix_ps->seg_as[3], cal_ps->negHS, HY8413_CAL_RNG_NEG,
+                         (long)cal_ps->negHS - cal_ps->negFS, offset_a[3] );
+      break;
+
+    case factor_3pt:
+      drvHy8413_cal_seg( &fix_ps->seg_as[0], cal_ps->zero,  HY8413_CAL_RNG3_NEG,
+                         (long)cal_ps->zero  - cal_ps->negFS, offset_a[2] );
+      drvHy8413_cal_seg( &fix_ps->seg_as[1], cal_ps->zero,  HY8413_CAL_RNG3_POS,
+                         (long)cal_ps->posFS - cal_ps->zero,  offset_a[1] );
+      break;
+
+    default:
+      break;
+  }
+  return;
+}
+
+/*====================================================
+
+  Abs:  Set up the fixed-point calibration of a card
+
+  Name: drvHy8413_cal_fix_build
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function sets up the fixed-point segments of each
+       calibrated channel for the current data format. The
+       segments are withdrawn from the readers meanwhile. The
+       calibration generation is advanced, so the EGU
+       coefficients are set up again.
+       Whether drvHy8413_cal_val() uses them is set apart,
+       with ip8413CalFix().
+
+  Side: Called at init once the calibration data is read.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - No calibration data on the card
+
+=======================================================*/
+long drvHy8413_cal_fix_build( void * const card_p )
+{
+  unsigned short       c;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+
+  if ( card_ps->cal_s.type == nocal ) return( ERROR );
+
+  card_ps->cal_s.fixSet = 0;
+  HY8413_WMB();
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    drvHy8413_cal_fix_set( &card_ps->cal_s.fix_as[c],
+                           &cal_ps->gain_a[card_ps->format][0],
+                           card_ps->cal_s.type );
+  }
+  card_ps->cal_s.fixFormat = card_ps->format;
+  card_ps->cal_s.gen++;
+  HY8413_WMB();
+  card_ps->cal_s.fixSet = 1;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Evaluate a fixed-point calibration segment
+
+  Name: drvHy8413_cal_eval
+
+  Args: seg_ps                          Segment
+          Type: pointer
+          Use:  hytec_ipmCalSeg_ts const * const
+          Acc:  read-only
+          Mech: By reference
+
+        rval                            Raw data value
+          Type: integer
+          Use:  long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function evaluates the segment with integer
+       multiply and shift. A segment with a zero span saturates
+       where drvHy8413_cal_adc() divides by zero.
+
+  Side: None
+
+  Ret:  long
+             calibrated value, 0 to 65535
+
+=======================================================*/
+static long drvHy8413_cal_eval( hytec_ipmCalSeg_ts const * const seg_ps,
+                                long                             rval )
+{
+  long                      d;
+  long                      val;
+  unsigned long long        ad;
+
+  d = rval - seg_ps->base;
+  if ( !seg_ps->sign ) return( (d > 0) ? 65535 : 0 );
+
+  ad = (d < 0) ? -d : d;
+  if ( (d < 0) == (seg_ps->sign < 0) )
+    val = seg_ps->offset + (long)((ad * seg_ps->mc) >> 32);
+  else
+    val = seg_ps->offset - (long)((ad * seg_ps->mf + 0xffffffffULL) >> 32);
+
+  if ( val > 65535 )
+    val = 65535;
+  else if ( val < 0 )
+    val = 0;
+  return( val );
+}
+
+/*====================================================
+
+  Abs:  Calibrate a raw value in fixed point
+
+  Name: drvHy8413_cal_fix
+
+  Args: fix_ps                          Fixed-point calibration
+          Type: pointer
+          Use:  hytec_ipmCalFix_ts const * const
+          Acc:  read-only
+          Mech: By reference
+
+        calType                         Calibration type
+          Type: integer                 Note: 1 = 3-point
+          Use:  unsigned short                2 = 5-point
+          Acc:  read-only
+          Mech: By value
+
+        rval                            Raw data value
+          Type: integer
+          Use:  long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function selects the segment as
+       drvHy8413_cal_adc() does and evaluates it with
+       drvHy8413_cal_eval().
+
+  Side: None
+
+  Ret:  long
+             calibrated value, 0 to 65535
+
+=======================================================*/
+long drvHy8413_cal_fix( hytec_ipmCalFix_ts const * const fix_ps,
+                        unsigned short                   calType,
+                        long                             rval )
+{
+  hytec_ipmCalSeg_ts const *seg_ps;
+
+  switch( calType )
+  {
+    case factor_5pt:
+      if ( rval > fix_ps->posHS )
+        seg_ps = &fix_ps->seg_as[0];
+      else if ( rval >= fix_ps->zero )
+        seg_ps = &fix_ps->seg_as[1];
+      else if ( rval >= fix_ps->negHS )
+        seg_ps = &fix_ps->seg_as[2];
+      else
+        seg_ps = &fix_ps->seg_as[3];
+      break;
+
+    case factor_3pt:
+      seg_ps = &fix_ps->seg_as[(rval < fix_ps->zero) ? 0 : 1];
+      break;
+
+    default:
+      return( 0 );
+  }
+  return( drvHy8413_cal_eval( seg_ps, rval ) );
+}
+
+/*====================================================
+
+  Abs:  Calibrate a strided block of one channel
+
+  Name: drvHy8413_cal_run
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-only
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        src_a                           Raw samples
+          Type: array
+          Use:  unsigned short const *
+          Acc:  read-only
+          Mech: By reference
+
+        dst_a                           Calibrated samples
+          Type: array                   Note: may be src_a
+          Use:  unsigned short *
+          Acc:  write-only
+          Mech: By reference
+
+        n                               Number of samples
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        inc                             Distance between samples
+          Type: integer                 Note: 1, or HY8413_NUM_CHAN
+          Use:  unsigned short                in a group block
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function calibrates n samples of a channel with
+       the channel table when the tables are in use, otherwise
+       with the fixed-point segments. With the breakpoints in
+       order the segment index is the number of breakpoints
+       above the raw value, posHS being inclusive as in
+       drvHy8413_cal_adc(). Otherwise, or before the segments
+       are set up, each sample goes through drvHy8413_cal_val().
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Calibration not enabled for the channel,
+                     dst_a is not written
+
+=======================================================*/
+static long drvHy8413_cal_run( IPADC_ID                     card_ps,
+                               unsigned short               chan,
+                               unsigned short const       * src_a,
+                               unsigned short             * dst_a,
+                               unsigned long                n,
+                               unsigned short               inc )
+{
+  unsigned long              k;
+  long                       rval;
+  long                       negHS;
+  long                       zero;
+  long                       posHS;
+  unsigned short const      *lut_a;
+  hytec_ipmCalFix_ts const  *fix_ps;
+  hytec_ipmCalChan_ts const *cal_ps  = &card_ps->cal_s.chan_as[chan];
+
+  if ( !(cal_ps->enb && card_ps->cal_s.enb && cal_ps->init) ) return( ERROR );
+
+  if ( card_ps->cal_s.lut )
+  {
+    HY8413_RMB();
+    lut_a = card_ps->cal_s.lut_a[chan];
+    if ( lut_a )
+    {
+      for (k=0; k<n; k++, src_a+=inc, dst_a+=inc)
+        *dst_a = lut_a[*src_a];
+      return( OK );
+    }
+  }
+
+  fix_ps = &card_ps->cal_s.fix_as[chan];
+  if ( card_ps->cal_s.fixSet )
+  {
+    HY8413_RMB();
+    if ( fix_ps->ordered )
+    {
+      negHS = fix_ps->negHS;
+      zero  = fix_ps->zero;
+      posHS = fix_ps->posHS + 1;
+      switch( card_ps->cal_s.type )
+      {
+        case factor_5pt:
+          for (k=0; k<n; k++, src_a+=inc, dst_a+=inc)
+          {
+            rval   = *src_a;
+            *dst_a = (unsigned short)drvHy8413_cal_eval(
+                        &fix_ps->seg_as[(rval < posHS) + (rval < zero) + (rval < negHS)], rval );
+          }
+          return( OK );
+
+        case factor_3pt:
+          for (k=0; k<n; k++, src_a+=inc, dst_a+=inc)
+          {
+            rval   = *src_a;
+            *dst_a = (unsigned short)drvHy8413_cal_eval( &fix_ps->seg_as[rval >= zero], rval );
+          }
+          return( OK );
+
+        default:
+          break;
+      }
+    }
+  }
+
+  for (k=0; k<n; k++, src_a+=inc, dst_a+=inc)
+    *dst_a = (unsigned short)drvHy8413_cal_val( card_ps, chan, *src_a );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Calibrate a block of samples of one channel
+
+  Name: drvHy8413_cal_chan_blk
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        src_a                           Raw samples
+          Type: array
+          Use:  unsigned short const *
+          Acc:  read-only
+          Mech: By reference
+
+        dst_a                           Calibrated samples
+          Type: array                   Note: may be src_a
+          Use:  unsigned short *
+          Acc:  write-only
+          Mech: By reference
+
+        n                               Number of samples
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function calibrates n consecutive samples of a
+       channel, such as a waveform of the FIFO capture, in one
+       call. The result is that of drvHy8413_cal_val() on each
+       sample.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid channel or calibration not enabled
+                     for the channel, dst_a is not written
+
+=======================================================*/
+long drvHy8413_cal_chan_blk( void const           * const card_p,
+                             unsigned short               chan,
+                             unsigned short const * const src_a,
+                             unsigned short       * const dst_a,
+                             unsigned long                n )
+{
+  if ( chan >= HY8413_NUM_CHAN ) return( ERROR );
+  return( drvHy8413_cal_run( (IPADC_ID)card_p, chan, src_a, dst_a, n, 1 ) );
+}
+
+/*====================================================
+
+  Abs:  Calibrate a block of 16-channel groups
+
+  Name: drvHy8413_cal_grp_blk
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+        src_a                           Raw samples
+          Type: array                   Note: channel 0 to 15 of
+          Use:  unsigned short const *        each group in turn
+          Acc:  read-only
+          Mech: By reference
+
+        dst_a                           Calibrated samples
+          Type: array                   Note: may be src_a
+          Use:  unsigned short *
+          Acc:  write-only
+          Mech: By reference
+
+        ngrp                            Number of groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function calibrates ngrp groups of 16 interleaved
+       channel samples, as the FIFO and the register snapshot
+       hold them, one channel at a time. The samples of a
+       channel with calibration not enabled are copied raw.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_cal_grp_blk( void const           * const card_p,
+                            unsigned short const * const src_a,
+                            unsigned short       * const dst_a,
+                            unsigned long                ngrp )
+{
+  unsigned short c;
+  unsigned long  k;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    if ( drvHy8413_cal_run( card_ps, c, src_a+c, dst_a+c, ngrp, HY8413_NUM_CHAN ) == OK ) continue;
+    if ( dst_a != src_a )
+      for (k=c; k<ngrp*HY8413_NUM_CHAN; k+=HY8413_NUM_CHAN)
+        dst_a[k] = src_a[k];
+  }
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Fold the calibration of a channel into EGU coefficients
+
+  Name: drvHy8413_cal_egu_set
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        egul                            EGU at 0 calibrated counts
+          Type: float                   Note: equal to eguf for
+          Use:  double                        volts of the card range
+          Acc:  read-only
+          Mech: By value
+
+        eguf                            EGU at 65535 calibrated counts
+          Type: float
+          Use:  double
+          Acc:  read-only
+          Mech: By value
+
+        egu_ps                          EGU coefficients
+          Type: pointer
+          Use:  hytec_ipmCalEgu_ts * const
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function folds the calibration segments of the
+       channel, the data format and the EGU range into one
+       pair of coefficients per segment, so that
+
+            val = a + b * raw
+
+       is the calibrated value scaled linearly from egul at 0
+       to eguf at 65535 counts, as LINR=LINEAR would with the
+       slope of init_ai. With egul equal to eguf the value is
+       in volts of the card range, as the waveform records
+       scale it. Without calibration the raw value is scaled
+       in the data format of the card. The calibrated counts
+       are not truncated, and the value is clipped at the EGU
+       of 0 and 65535 counts as drvHy8413_cal_adc() clips.
+
+       A segment with a zero span, or 5-point breakpoints out
+       of order, cannot be folded: the channel then goes
+       through drvHy8413_cal_val() and the EGU scale.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid channel
+
+=======================================================*/
+long drvHy8413_cal_egu_set( void const         * const card_p,
+                            unsigned short             chan,
+                            double                     egul,
+                            double                     eguf,
+                            hytec_ipmCalEgu_ts * const egu_ps )
+{
+  unsigned short           i;
+  unsigned short           nseg    = 0;
+  long                     base_a[MAX_CAL_SEG];
+  long                     rng_a[MAX_CAL_SEG];
+  long                     scale_a[MAX_CAL_SEG];
+  long                     off_a[MAX_CAL_SEG];
+  double                   fs;
+  double                   slope;
+  IPADC_ID                 card_ps = (IPADC_ID)card_p;
+  hytec_ipmCalChan_ts     *chan_ps;
+  hy8413_calData_ts const *cal_ps;
+
+  if ( chan >= HY8413_NUM_CHAN ) return( ERROR );
+
+  chan_ps        = &card_ps->cal_s.chan_as[chan];
+  cal_ps         = (hy8413_calData_ts const *)&chan_ps->gain_a[card_ps->format][0];
+  egu_ps->egul   = egul;
+  egu_ps->eguf   = eguf;
+  egu_ps->gen    = card_ps->cal_s.gen;
+  egu_ps->format = card_ps->format;
+  egu_ps->range  = card_ps->range;
+  egu_ps->cal    = (chan_ps->enb && card_ps->cal_s.enb && chan_ps->init) ? 1 : 0;
+
+  if ( eguf == egul )
+  {
+    fs         = (card_ps->range == five_plus_minus) ? 5.0 : 10.0;
+    egu_ps->k   = fs/32768.0;
+    egu_ps->off = -fs;
+  }
+  else
+  {
+    egu_ps->k   = (eguf - egul)/65535.0;
+    egu_ps->off = egul;
+  }
+  egu_ps->lo = egu_ps->off;
+  egu_ps->hi = egu_ps->off + 65535.0*egu_ps->k;
+  if ( egu_ps->hi < egu_ps->lo )
+  {
+    egu_ps->lo = egu_ps->hi;
+    egu_ps->hi = egu_ps->off;
+  }
+
+  egu_ps->negHS = cal_ps->negHS;
+  egu_ps->zero  = cal_ps->zero;
+  egu_ps->posHS = cal_ps->posHS;
+  if ( !egu_ps->cal )
+  {
+    /* Raw counts, two's complement read as signed */
+    egu_ps->mode   = 0;
+    egu_ps->b_a[0] = egu_ps->k;
+    egu_ps->a_a[0] = egu_ps->off;
+    if ( card_ps->format == twos_compliment )
+      egu_ps->a_a[0] += 32768.0*egu_ps->k;
+    return( OK );
+  }
+
+  /* Segments as drvHy8413_cal_fix_set() sets them up */
+  switch( card_ps->cal_s.type )
+  {
+    case factor_5pt:
+      nseg       = 4;
+      base_a[0]  = cal_ps->posHS;  rng_a[0] = HY8413_CAL_RNG_POS;
+      scale_a[0] = (long)cal_ps->posFS - cal_ps->posHS;  off_a[0] = offset_a[0];
+      base_a[1]  = cal_ps->zero;   rng_a[1] = HY8413_CAL_RNG_POS;
+      scale_a[1] = (long)cal_ps->posHS - cal_ps->zero;   off_a[1] = offset_a[1];
+      base_a[2]  = cal_ps->zero;   rng_a[2] = HY8413_CAL_RNG_NEG;
+      scale_a[2] = (long)cal_ps->zero  - cal_ps->negHS;  off_a[2] = offset_a[2];
+      base_a[3]  = cal_ps->negHS;  rng_a[3] = HY8413_CAL_RNG_NEG;
+      scale_a[3] = (long)cal_ps->negHS - cal_ps->negFS;  off_a[3] = offset_a[3];
+      egu_ps->mode = ((cal_ps->negHS <= cal_ps->zero) && (cal_ps->zero <= cal_ps->posHS)) ? 3 : -1;
+      break;
+
+    case factor_3pt:
+      nseg       = 2;
+      base_a[0]  = cal_ps->zero;   rng_a[0] = HY8413_CAL_RNG3_NEG;
+      scale_a[0] = (long)cal_ps->zero  - cal_ps->negFS;  off_a[0] = offset_a[2];
+      base_a[1]  = cal_ps->zero;   rng_a[1] = HY8413_CAL_RNG3_POS;
+      scale_a[1] = (long)cal_ps->posFS - cal_ps->zero;   off_a[1] = offset_a[1];
+      egu_ps->mode = 1;
+      break;
+
+    default:
+      egu_ps->mode = -1;
+      break;
+  }
+
+  for (i=0; i<nseg; i++)
+  {
+    if ( !scale_a[i] )
+    {
+      egu_ps->mode = -1;
+      break;
+    }
+    slope          = (double)rng_a[i]/(double)scale_a[i];
+    egu_ps->b_a[i] = egu_ps->k*slope;
+    egu_ps->a_a[i] = egu_ps->off + egu_ps->k*((double)off_a[i] - (double)base_a[i]*slope);
+  }
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Convert a raw value of a channel to EGU
+
+  Name: drvHy8413_cal_egu
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        egu_ps                          EGU coefficients
+          Type: pointer                 Note: set up by
+          Use:  hytec_ipmCalEgu_ts * const    drvHy8413_cal_egu_set()
+          Acc:  read-write
+          Mech: By reference
+
+        rval                            Raw data value
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function returns the value of a raw sample in EGU
+       with the folded coefficients, picking the segment by
+       summing comparisons. The coefficients are set up again
+       first if the calibration data, the enables, the data
+       format or the range of the card changed since.
+
+  Side: None
+
+  Ret:  double
+             Value in EGU
+
+=======================================================*/
+double drvHy8413_cal_egu( void const         * const card_p,
+                          unsigned short             chan,
+                          hytec_ipmCalEgu_ts * const egu_ps,
+                          unsigned short             rval )
+{
+  long                 x       = rval;
+  unsigned short       i       = 0;
+  unsigned short       cal;
+  double               val;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+  hytec_ipmCalChan_ts *cal_ps  = &card_ps->cal_s.chan_as[chan];
+
+  cal = (cal_ps->enb && card_ps->cal_s.enb && cal_ps->init) ? 1 : 0;
+  if ( (egu_ps->gen    != card_ps->cal_s.gen) ||
+       (egu_ps->format != card_ps->format)    ||
+       (egu_ps->range  != card_ps->range)     ||
+       (egu_ps->cal    != cal) )
+    drvHy8413_cal_egu_set( card_ps, chan, egu_ps->egul, egu_ps->eguf, egu_ps );
+
+  switch( egu_ps->mode )
+  {
+    case 0:
+      if ( egu_ps->format == twos_compliment ) x = (short)rval;
+      break;
+
+    case 1:
+      i = (x >= egu_ps->zero);
+      break;
+
+    case 3:
+      i = (x <= egu_ps->posHS) + (x < egu_ps->zero) + (x < egu_ps->negHS);
+      break;
+
+    default:
+      return( egu_ps->off + egu_ps->k*drvHy8413_cal_val( card_ps, chan, rval ) );
+  }
+
+  val = egu_ps->a_a[i] + egu_ps->b_a[i]*(double)x;
+  if ( val > egu_ps->hi )
+    val = egu_ps->hi;
+  else if ( val < egu_ps->lo )
+    val = egu_ps->lo;
+  return( val );
+}
+
+/*====================================================
+
+  Abs:  Trim one calibration point
+
+  Name: drvHy8413_cal_trim_pt
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-only
+          Mech: By reference
+
+        val                             Calibration point
+          Type: integer                 Note: offset binary
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function moves a calibration point read from the
+       id prom by the drift trim of the card, rounded to the
+       nearest count and clipped to 0..65535.
+
+  Side: None
+
+  Ret:  unsigned short
+             Trimmed calibration point, offset binary
+
+=======================================================*/
+static unsigned short drvHy8413_cal_trim_pt( IPADC_ID       card_ps,
+                                             unsigned short val )
+{
+  double v;
+
+  v = card_ps->cal_s.trimGain * (double)val + card_ps->cal_s.trimOff + 0.5;
+  if ( v < 0.0 )     return( 0 );
+  if ( v > 65535.0 ) return( 65535 );
+  return( (unsigned short)v );
+}
+
+/*====================================================
+
+  Abs:  Select the calibration data of the range in use
+
+  Name: drvHy8413_cal_range
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function copies the calibration data of the range
+       in use, read at init for both ranges, to the calibration
+       points of each channel in both data formats, and sets up
+       the fixed-point segments for them. A channel without
+       data for the range is flagged as not calibrated. The
+       segments are withdrawn from the readers meanwhile, and
+       so are the tables when they were built for another range
+       or format, readers of the calibration points during the
+       copy may mix both ranges for a sample. When a drift trim
+       is set for the range, the points are trimmed on the way,
+       and the tables of the range stay in use until rebuilt.
+
+  Side: No id prom page is read.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - No calibration data on the card
+
+=======================================================*/
+long drvHy8413_cal_range( void * const card_p )
+{
+  unsigned short       c;
+  unsigned short       i;
+  unsigned short       val;
+  unsigned short       trim;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+
+  if ( card_ps->cal_s.type == nocal ) return( ERROR );
+
+  trim = card_ps->cal_s.trim && (card_ps->cal_s.trimRange == card_ps->range);
+  if ( (card_ps->cal_s.lutRange  != card_ps->range) ||
+       (card_ps->cal_s.lutFormat != card_ps->format) )
+    card_ps->cal_s.lut = 0;
+  card_ps->cal_s.fixSet = 0;
+  HY8413_WMB();
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    if ( !(cal_ps->rngInit & (1 << card_ps->range)) )
+    {
+      cal_ps->init = 0;
+      continue;
+    }
+    for (i=0; i<MAX_CAL_PTS; i++)
+    {
+      val = cal_ps->rng_a[card_ps->range][i];
+      if ( trim ) val = drvHy8413_cal_trim_pt( card_ps, val );
+      cal_ps->gain_a[offset_binary][i]   = val;
+      cal_ps->gain_a[twos_compliment][i] = val & TWOS_COMPLIMENT_MAX;
+    }
+    cal_ps->init = 1;
+  }
+  card_ps->cal_s.range = card_ps->range;
+  return( drvHy8413_cal_fix_build( card_ps ) );
+}
+
+/*====================================================
+
+  Abs:  Trim the calibration points for drift
+
+  Name: drvHy8413_cal_trim
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        gain                            Gain trim
+          Type: float
+          Use:  double
+          Acc:  read-only
+          Mech: By value
+
+        off                             Offset trim
+          Type: float                   Note: offset binary counts
+          Use:  double
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function trims the calibration points of the range
+       in use,  point = gain * id prom point + off,  so they
+       follow the drift of the module since the baseline was
+       taken (see drvHy8413Drift.c). A gain of 1 and an offset
+       of 0 go back to the id prom points.
+
+       The trim is folded into the points, so the calibration
+       tables, the fixed-point segments and the EGU
+       coefficients carry it and calibration costs nothing
+       more per sample. As the points are integer, nothing is
+       rebuilt until the trim moves a point by a count.
+
+  Side: The calibration lock is taken. The tables, when in
+        use, are rebuilt.
+
+  Ret:  long
+             OK    - Successful operation, or no change
+             ERROR - No calibration data on the card
+
+=======================================================*/
+long drvHy8413_cal_trim( void * const card_p, double gain, double off )
+{
+  long                 status = OK;
+  unsigned short       c;
+  unsigned short       i;
+  unsigned short       lut;
+  unsigned short       val;
+  unsigned short       trim;
+  unsigned short       chg    = 0;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+
+  if ( card_ps->cal_s.type == nocal ) return( ERROR );
+
+  epicsMutexMustLock( card_ps->cal_s.lock );
+  trim = (gain != 1.0) || (off != 0.0);
+  card_ps->cal_s.trimGain  = gain;
+  card_ps->cal_s.trimOff   = off;
+  card_ps->cal_s.trimRange = card_ps->range;
+  for (c=0; (c<HY8413_NUM_CHAN) && !chg; c++)
+  {
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    if ( !cal_ps->init ) continue;
+    for (i=0; i<MAX_CAL_PTS; i++)
+    {
+      val = cal_ps->rng_a[card_ps->range][i];
+      if ( trim ) val = drvHy8413_cal_trim_pt( card_ps, val );
+      if ( val != cal_ps->gain_a[offset_binary][i] ) chg = 1;
+    }
+  }
+  card_ps->cal_s.trim = trim;
+  if ( chg )
+  {
+    lut    = card_ps->cal_s.lut;
+    status = drvHy8413_cal_range( card_ps );
+    if ( (status == OK) && lut )
+      status = drvHy8413_cal_lut_build( card_ps );
+    card_ps->cal_s.ntrim++;
+  }
+  epicsMutexUnlock( card_ps->cal_s.lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Follow a range or format change
+
+  Name: drvHy8413_cal_check
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function reads back the range and data format
+       from the ACR into the card information. On a range
+       change the calibration data of the new range, held
+       since init, is selected. The fixed-point segments, when
+       set up, follow the format. Both take a few microseconds.
+
+       The calibration tables, when allocated, are rebuilt if
+       the range or format changed since they were built. They
+       are withdrawn at once and the rebuild, about a million
+       drvHy8413_cal_adc() calls, is left to the table task of
+       the card (see drvHy8413_cal_lut_task), started the first
+       time, so the record writing the ACR does not wait for
+       it.
+
+  Side: Called after the ACR has been written, see
+        drvHy8413_acr_wt(). The calibration lock is taken.
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_cal_check( void * const card_p )
+{
+  long           status  = OK;
+  unsigned short val;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  epicsMutexMustLock( card_ps->cal_s.lock );
+  val = io_ps->acr;
+  card_ps->format = (val & HY8413_ACR_2C)  >> HY8413_ACR_2C_SHFT;
+  card_ps->range  = (val & HY8413_ACR_RGE) >> HY8413_ACR_RGE_SHFT;
+
+  if ( (card_ps->cal_s.type != nocal) && (card_ps->cal_s.range != card_ps->range) )
+    drvHy8413_cal_range( card_ps );
+  else if ( card_ps->cal_s.fixSet && (card_ps->cal_s.fixFormat != card_ps->format) )
+    drvHy8413_cal_fix_build( card_ps );
+
+  if ( card_ps->cal_s.lutBytes &&
+       !(card_ps->cal_s.lut &&
+         (card_ps->cal_s.lutFormat == card_ps->format) &&
+         (card_ps->cal_s.lutRange  == card_ps->range)) )
+  {
+    card_ps->cal_s.lut = 0;
+    if ( !card_ps->cal_s.lutTid )
+    {
+      card_ps->cal_s.lutEvt = epicsEventMustCreate( epicsEventEmpty );
+      card_ps->cal_s.lutTid = epicsThreadMustCreate( HY8413_CAL_NAME,
+                                                     HY8413_CAL_PRI,
+                                                     HY8413_CAL_STACK,
+                                                     drvHy8413_cal_lut_task,
+                                                     card_ps );
+    }
+    epicsEventSignal( card_ps->cal_s.lutEvt );
+  }
+  epicsMutexUnlock( card_ps->cal_s.lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Rebuild the calibration tables after a change
+
+  Name: drvHy8413_cal_lut_task
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This task rebuilds the calibration tables of a card
+       when asked by drvHy8413_cal_check(), unless they have
+       been rebuilt for the range and format in use since.
+       Readers fall back to drvHy8413_cal_adc() meanwhile.
+
+  Side: Runs until the ioc is rebooted. The calibration
+        lock is taken for the rebuild.
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_cal_lut_task( void *card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  while (1)
+  {
+    epicsEventMustWait( card_ps->cal_s.lutEvt );
+    epicsMutexMustLock( card_ps->cal_s.lock );
+    if ( !(card_ps->cal_s.lut &&
+           (card_ps->cal_s.lutFormat == card_ps->format) &&
+           (card_ps->cal_s.lutRange  == card_ps->range)) )
+      drvHy8413_cal_lut_build( card_ps );
+    epicsMutexUnlock( card_ps->cal_s.lock );
+  }
+}
+
+/*====================================================
+
+  Abs:  Display calibration table information
+
+  Name: drvHy8413_cal_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        state and memory use of the calibration tables and
+        of the fixed-point calibration.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_cal_report( void const * const card_p )
+{
+  unsigned short c;
+  unsigned short n       = 0;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  static const char *format_ac[2]={"Two's Compliment","Offset Binary"};
+
+  if ( card_ps->cal_s.fixSet )
+    printf("\tCalibration fixed point: %s  format: %s  memory: %lu bytes\n",
+           card_ps->cal_s.fix ? "In-Use" : "Blocks-Only",
+           format_ac[card_ps->cal_s.fixFormat],
+           (unsigned long)sizeof(card_ps->cal_s.fix_as) );
+  if ( card_ps->cal_s.trim || card_ps->cal_s.ntrim )
+    printf("\tCalibration drift trim: %s  gain: %.6f  offset: %.2f counts  trims: %lu\n",
+           card_ps->cal_s.trim ? "In-Use" : "Not-In-Use",
+           card_ps->cal_s.trimGain,
+           card_ps->cal_s.trimOff,
+           card_ps->cal_s.ntrim );
+  if ( !card_ps->cal_s.lutBytes ) return;
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+    if ( card_ps->cal_s.lut_a[c] ) n++;
+  printf("\tCalibration tables: %s  channels: %hu  memory: %lu kbytes  format: %s  range: +/-%dV  builds: %lu\n",
+         card_ps->cal_s.lut ? "In-Use" : "Not-In-Use",
+         n,
+         card_ps->cal_s.lutBytes/1024,
+         format_ac[card_ps->cal_s.lutFormat],
+         (card_ps->cal_s.lutRange == five_plus_minus) ? 5 : 10,
+         card_ps->cal_s.nbuild );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Build or drop the calibration tables (shell)
+
+  Name: ip8413CalLut
+
+  Args: name_c                          Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        enable                          Use tables
+          Type: integer                 Note: 0=drvHy8413_cal_adc()
+          Use:  int                           1=tables
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  With enable set, the calibration tables of the card
+        are built, or rebuilt, and used. Otherwise they are
+        withdrawn and calibration goes back to
+        drvHy8413_cal_adc(). The memory is kept for reuse.
+
+  Side: The calibration lock is taken for a build.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Card not found or no calibration data
+
+=======================================================*/
+long ip8413CalLut( char const * const name_c, int enable )
+{
+  long      status;
+  IPADC_ID  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( !enable )
+  {
+     card_ps->cal_s.lut = 0;
+     return( OK );
+  }
+  epicsMutexMustLock( card_ps->cal_s.lock );
+  status = drvHy8413_cal_lut_build( card_ps );
+  epicsMutexUnlock( card_ps->cal_s.lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Use or drop the fixed-point calibration (shell)
+
+  Name: ip8413CalFix
+
+  Args: name_c                          Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        enable                          Use fixed point
+          Type: integer                 Note: 0=drvHy8413_cal_adc()
+          Use:  int                           1=fixed point
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  With enable set, the fixed-point segments of the card
+        are set up, if not already for the current format, and
+        used by drvHy8413_cal_val() when no calibration tables
+        are in use. Otherwise drvHy8413_cal_val() goes back to
+        drvHy8413_cal_adc(). The block calibration always uses
+        the segments.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Card not found or no calibration data
+
+=======================================================*/
+long ip8413CalFix( char const * const name_c, int enable )
+{
+  IPADC_ID  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( !enable )
+  {
+     card_ps->cal_s.fix = 0;
+     return( OK );
+  }
+  if ( !card_ps->cal_s.fixSet || (card_ps->cal_s.fixFormat != card_ps->format) )
+  {
+     if ( drvHy8413_cal_fix_build( card_ps ) != OK ) return( ERROR );
+  }
+  card_ps->cal_s.fix = 1;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Check and time the fixed-point calibration (shell)
+
+  Name: ip8413CalFixTest
+
+  Args: name_c                          Card name
+          Type: char-string             Note: NULL or "" for the
+          Use:  char const *                  synthetic sets only
+          Acc:  read-only
+          Mech: By reference
+
+        nloop                           Timing passes
+          Type: integer                 Note: default 10, of
+          Use:  int                           65536 samples each
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function compares drvHy8413_cal_fix() with
+        drvHy8413_cal_adc() bit for bit over all 65536 raw
+        values, for both 3 and 5-point calibration, on:
+
+          - 256 synthetic calibration sets spread around the
+            nominal points, and a few with coincident points
+          - the calibration data of each calibrated channel
+            of the card, in its current format, if given
+
+        Inputs where drvHy8413_cal_adc() divides zero by zero
+        have no defined result and are counted, not compared.
+        The time per sample of both, and of the table when the
+        card has one, is then measured on the first set.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - All results match
+             ERROR - Mismatch found or card not found
+
+=======================================================*/
+long ip8413CalFixTest( char const * name_c, int nloop )
+{
+  long                status  = OK;
+  int                 i;
+  int                 k;
+  unsigned short      t;
+  unsigned short      c;
+  unsigned short      nset;
+  unsigned long       rval;
+  unsigned long       seed    = 12345;
+  unsigned long       nchk    = 0;
+  unsigned long       nbad    = 0;
+  unsigned long       nundef  = 0;
+  long                ref;
+  long                val;
+  volatile long       sink    = 0;
+  double              dt_a[3] = {0.0,0.0,0.0};
+  epicsTimeStamp      t0,t1;
+  unsigned short      gain_a[MAX_CAL_PTS];
+  hytec_ipmCalFix_ts  fix_s;
+  IPADC_ID            card_ps = NULL;
+  static const unsigned short nom_a[MAX_CAL_PTS] = {0x0010,0x4008,0x8000,0xbff8,0xfff0};
+  static const unsigned short calType_a[2]       = {factor_3pt,factor_5pt};
+
+  if ( name_c && name_c[0] )
+  {
+    card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+    if ( !card_ps )
+    {
+       errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+       return( ERROR );
+    }
+  }
+  if ( nloop <= 0 ) nloop = 10;
+
+  /* Synthetic sets, then the card channels */
+  nset = 256 + 4 + (card_ps ? HY8413_NUM_CHAN : 0);
+  for (i=0; i<nset; i++)
+  {
+    if ( i < 256 )
+    {
+      for (k=0; k<MAX_CAL_PTS; k++)
+      {
+        seed = seed * 1103515245UL + 12345UL;
+        gain_a[k] = nom_a[k] + (short)(((seed >> 16) & 0x3ff) - 0x200);
+      }
+    }
+    else if ( i < 260 )
+    {
+      /* Coincident points, zero spans */
+      memcpy( gain_a, nom_a, sizeof(gain_a) );
+      gain_a[i-256]   = gain_a[i-256+1];
+    }
+    else
+    {
+      c = i - 260;
+      if ( !card_ps->cal_s.chan_as[c].init ) continue;
+      memcpy( gain_a, &card_ps->cal_s.chan_as[c].gain_a[card_ps->format][0], sizeof(gain_a) );
+    }
+
+    for (t=0; t<2; t++)
+    {
+      if ( card_ps && (i >= 260) && (calType_a[t] != card_ps->cal_s.type) ) continue;
+      drvHy8413_cal_fix_set( &fix_s, gain_a, calType_a[t] );
+      for (rval=0; rval<HY8413_CAL_LUT_NELM; rval++)
+      {
+        ref = drvHy8413_cal_adc( gain_a, calType_a[t], 0, (long)rval );
+        if ( (ref < 0) || (ref > 65535) )
+        {
+          nundef++;
+          continue;
+        }
+        val = drvHy8413_cal_fix( &fix_s, calType_a[t], (long)rval );
+        nchk++;
+        if ( val != ref )
+        {
+          if ( nbad++ < 10 )
+            printf("\tMISMATCH set %d type %hu raw 0x%04lx: double %ld fixed %ld\n",
+                   i, calType_a[t], rval, ref, val );
+        }
+      }
+    }
+  }
+  printf("IP8413 fixed-point calibration: %lu values compared, %lu mismatches, %lu undefined\n",
+         nchk, nbad, nundef );
+  if ( nbad ) status = ERROR;
+
+  /* Time per sample on the nominal 5-point set */
+  memcpy( gain_a, nom_a, sizeof(gain_a) );
+  drvHy8413_cal_fix_set( &fix_s, gain_a, factor_5pt );
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (rval=0; rval<HY8413_CAL_LUT_NELM; rval++)
+      sink += drvHy8413_cal_adc( gain_a, factor_5pt, 0, (long)rval );
+  epicsTimeGetCurrent( &t1 );
+  dt_a[0] = epicsTimeDiffInSeconds( &t1, &t0 );
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (rval=0; rval<HY8413_CAL_LUT_NELM; rval++)
+      sink += drvHy8413_cal_fix( &fix_s, factor_5pt, (long)rval );
+  epicsTimeGetCurrent( &t1 );
+  dt_a[1] = epicsTimeDiffInSeconds( &t1, &t0 );
+  printf("\tdouble: %8.1f ns/sample  fixed: %8.1f ns/sample",
+         dt_a[0]*1.0e9/((double)nloop*HY8413_CAL_LUT_NELM),
+         dt_a[1]*1.0e9/((double)nloop*HY8413_CAL_LUT_NELM) );
+  if ( card_ps && card_ps->cal_s.lut )
+  {
+    for (c=0; (c<HY8413_NUM_CHAN) && !card_ps->cal_s.lut_a[c]; c++);
+    if ( c < HY8413_NUM_CHAN )
+    {
+      epicsTimeGetCurrent( &t0 );
+      for (i=0; i<nloop; i++)
+        for (rval=0; rval<HY8413_CAL_LUT_NELM; rval++)
+          sink += card_ps->cal_s.lut_a[c][rval];
+      epicsTimeGetCurrent( &t1 );
+      dt_a[2] = epicsTimeDiffInSeconds( &t1, &t0 );
+      printf("  table: %8.1f ns/sample", dt_a[2]*1.0e9/((double)nloop*HY8413_CAL_LUT_NELM) );
+    }
+  }
+  printf("\n");
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Check and time the block calibration (shell)
+
+  Name: ip8413CalBlkBench
+
+  Args: name_c                          Card name
+          Type: char-string             Note: NULL or "" for a
+          Use:  char const *                  synthetic card
+          Acc:  read-only
+          Mech: By reference
+
+        nloop                           Timing passes
+          Type: integer                 Note: default 10, of
+          Use:  int                           16 x 16384 samples each
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function calibrates a block of 16384 groups of 16
+        random raw samples and compares the result of
+        drvHy8413_cal_grp_blk() with drvHy8413_cal_adc() on
+        each sample. It then times, per sample:
+
+          - drvHy8413_cal_adc() on each sample
+          - drvHy8413_cal_val() on each sample, as read_ai did
+          - drvHy8413_cal_grp_blk() on the whole block
+          - drvHy8413_cal_chan_blk() on each channel of the
+            block, after separating the channels
+
+        With a card name the calibration state of the card is
+        used, as set up with ip8413CalLut() and ip8413CalFix().
+        Otherwise a card with 5-point calibration points spread
+        around the nominal ones is made up.
+
+  Side: Report is sent to the standard output device.
+        Allocates and frees about 2 Mbytes.
+
+  Ret:  long
+             OK    - All results match
+             ERROR - Mismatch found, card not found or no memory
+
+=======================================================*/
+long ip8413CalBlkBench( char const * name_c, int nloop )
+{
+  long                status  = OK;
+  int                 i;
+  int                 k;
+  unsigned short      c;
+  unsigned long       j;
+  unsigned long       n       = 16384 * HY8413_NUM_CHAN;
+  unsigned long       seed    = 54321;
+  unsigned long       nchk    = 0;
+  unsigned long       nbad    = 0;
+  long                ref;
+  volatile long       sink    = 0;
+  double              dt_a[4] = {0.0,0.0,0.0,0.0};
+  epicsTimeStamp      t0,t1;
+  unsigned short     *raw_a;
+  unsigned short     *out_a;
+  unsigned short     *sep_a;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID            card_ps = NULL;
+  IPADC_ID            syn_ps  = NULL;
+  static const unsigned short nom_a[MAX_CAL_PTS] = {0x0010,0x4008,0x8000,0xbff8,0xfff0};
+  static const char *type_ac[3] = {"none","3-point","5-point"};
+
+  if ( name_c && name_c[0] )
+  {
+    card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+    if ( !card_ps )
+    {
+       errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+       return( ERROR );
+    }
+  }
+  else
+  {
+    syn_ps = calloc( 1, sizeof(*syn_ps) );
+    if ( !syn_ps ) return( ERROR );
+    syn_ps->cal_s.type = factor_5pt;
+    syn_ps->cal_s.enb  = 1;
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      cal_ps       = &syn_ps->cal_s.chan_as[c];
+      cal_ps->init = 1;
+      cal_ps->enb  = 1;
+      for (k=0; k<MAX_CAL_PTS; k++)
+      {
+        seed = seed * 1103515245UL + 12345UL;
+        cal_ps->gain_a[0][k] = nom_a[k] + (short)(((seed >> 16) & 0x3ff) - 0x200);
+      }
+    }
+    drvHy8413_cal_fix_build( syn_ps );
+    card_ps = syn_ps;
+  }
+  if ( nloop <= 0 ) nloop = 10;
+
+  raw_a = calloc( n, sizeof(unsigned short) );
+  out_a = calloc( n, sizeof(unsigned short) );
+  sep_a = calloc( n, sizeof(unsigned short) );
+  if ( !raw_a || !out_a || !sep_a )
+  {
+    errlogPrintf("IP8413: ip8413CalBlkBench() out of memory\n");
+    if ( raw_a )  free( raw_a );
+    if ( out_a )  free( out_a );
+    if ( sep_a )  free( sep_a );
+    if ( syn_ps ) free( syn_ps );
+    return( ERROR );
+  }
+  for (j=0; j<n; j++)
+  {
+    seed = seed * 1103515245UL + 12345UL;
+    raw_a[j] = (unsigned short)(seed >> 16);
+  }
+
+  /* Check the block against drvHy8413_cal_adc() */
+  drvHy8413_cal_grp_blk( card_ps, raw_a, out_a, n/HY8413_NUM_CHAN );
+  for (j=0; j<n; j++)
+  {
+    c      = j % HY8413_NUM_CHAN;
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    if ( cal_ps->enb && card_ps->cal_s.enb && cal_ps->init )
+    {
+      ref = drvHy8413_cal_adc( &cal_ps->gain_a[card_ps->format][0],
+                               card_ps->cal_s.type,
+                               card_ps->format,
+                               raw_a[j] );
+      if ( (ref < 0) || (ref > 65535) ) continue;
+    }
+    else
+      ref = raw_a[j];
+    nchk++;
+    if ( out_a[j] != ref )
+    {
+      if ( nbad++ < 10 )
+        printf("\tMISMATCH chan %hu raw 0x%04hx: double %ld block %hu\n",
+               c, raw_a[j], ref, out_a[j] );
+    }
+  }
+  printf("IP8413 block calibration (%s): %lu values compared, %lu mismatches\n",
+         type_ac[card_ps->cal_s.type], nchk, nbad );
+  if ( nbad ) status = ERROR;
+
+  /* Time per sample */
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (j=0; j<n; j++)
+    {
+      cal_ps = &card_ps->cal_s.chan_as[j % HY8413_NUM_CHAN];
+      sink  += drvHy8413_cal_adc( &cal_ps->gain_a[card_ps->format][0],
+                                  card_ps->cal_s.type,
+                                  card_ps->format,
+                                  raw_a[j] );
+    }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[0] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (j=0; j<n; j++)
+      sink += drvHy8413_cal_val( card_ps, j % HY8413_NUM_CHAN, raw_a[j] );
+  epicsTimeGetCurrent( &t1 );
+  dt_a[1] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+  {
+    drvHy8413_cal_grp_blk( card_ps, raw_a, out_a, n/HY8413_NUM_CHAN );
+    sink += out_a[i];
+  }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[2] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  for (j=0; j<n; j++)
+    sep_a[(j % HY8413_NUM_CHAN)*(n/HY8413_NUM_CHAN) + j/HY8413_NUM_CHAN] = raw_a[j];
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+  {
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+      drvHy8413_cal_chan_blk( card_ps, c,
+                              &sep_a[c*(n/HY8413_NUM_CHAN)],
+                              &out_a[c*(n/HY8413_NUM_CHAN)],
+                              n/HY8413_NUM_CHAN );
+    sink += out_a[i];
+  }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[3] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  printf("\tns/sample  double: %.1f  cal_val: %.1f  group block: %.1f  channel blocks: %.1f\n",
+         dt_a[0]*1.0e9/((double)nloop*n),
+         dt_a[1]*1.0e9/((double)nloop*n),
+         dt_a[2]*1.0e9/((double)nloop*n),
+         dt_a[3]*1.0e9/((double)nloop*n) );
+  printf("\tms per 16 x 16384 block  double: %.3f  group block: %.3f\n",
+         dt_a[0]*1.0e3/nloop, dt_a[2]*1.0e3/nloop );
+
+  free( raw_a );
+  free( out_a );
+  free( sep_a );
+  if ( syn_ps ) free( syn_ps );
+  return( status );
+}
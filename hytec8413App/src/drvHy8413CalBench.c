@@ -0,0 +1,638 @@
+/*
+=============================================================
+
+  Abs:  Calibration benchmark for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413CalBench.c
+          *  drvHy8413_bench_ideal  - Ideal linear calibration of a raw value
+          *  drvHy8413_bench_set    - Load the calibration points of one case
+          *  drvHy8413_bench_case   - Check and time the calibration of one case
+             drvHy8413_cal_bench    - Calibration accuracy and throughput suite
+             ip8413CalBench         - Calibration accuracy and throughput suite (shell)
+
+          * indicates static routines
+
+  Rem:  drvHy8413_cal_adc() is the reference calibration of the
+        driver. The calibration tables, the fixed-point segments
+        and the block calibration (see drvHy8413Cal.c) must give
+        the same result for every raw value, and all of them are
+        only as good as drvHy8413_cal_adc() itself.
+
+        ip8413CalBench() sweeps all 65536 raw values of the 16
+        channels for each data format, range and calibration
+        type, 8 cases in all, and for each case reports:
+
+          - the largest deviation of drvHy8413_cal_adc(), and of
+            the raw value without calibration, from the ideal
+            linear calibration, in counts, and the raw value
+            where it is found
+          - the number of results of the tables, the fixed-point
+            segments and the block calibration that differ from
+            drvHy8413_cal_adc(), and of the EGU conversion, in
+            counts, that are not within the count drvHy8413_cal_adc()
+            truncates
+          - the time per sample of each
+
+        The ideal calibration maps the id prom points of the
+        channel onto the nominal codes of the reference voltages,
+        0x0010, 0x4008, 0x8000, 0xbff8 and 0xfff0 (-FS, -HS, 0,
+        +HS, +FS), straight between the points and extended past
+        the outer ones, in double precision. Two's complement
+        raw values are compared with it as offset binary, since
+        the calibrated value is offset binary in both formats.
+
+        The calibration points are those of the card for both
+        ranges when a calibrated card is given, otherwise
+        synthetic points spread around the nominal codes. A
+        channel whose points coincide has no defined result in
+        drvHy8413_cal_adc() and is skipped. The card itself is
+        not touched, the cases run on a scratch copy.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        17-Oct-2026, agent            (AGENT):
+           Check the EGU conversion, for the host test in ../tests
+        17-Oct-2026, agent            (AGENT):
+           Return the largest deviation of each data format from
+           drvHy8413_cal_bench, ip8413CalBench is now its wrapper
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "cantProceed.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/* Local Definitions */
+#define HY8413_BENCH_NRAW   HY8413_CAL_LUT_NELM  /* raw values per channel */
+#define HY8413_BENCH_EGUTOL 1.0e-6               /* EGU rounding, counts   */
+
+static const unsigned short nom_a[MAX_CAL_PTS] = {0x0010,0x4008,0x8000,0xbff8,0xfff0};
+
+/* Local Prototypes */
+static double drvHy8413_bench_ideal( unsigned short const * const pts_a,
+                                     unsigned short               calType,
+                                     unsigned short               rval );
+static unsigned short drvHy8413_bench_set( IPADC_ID       bench_ps,
+                                           IPADC_ID       card_ps,
+                                           unsigned short range );
+static long drvHy8413_bench_case( IPADC_ID               bench_ps,
+                                  unsigned short const * raw_a,
+                                  unsigned short       * out_a,
+                                  int                    nloop,
+                                  double               * dcal_p );
+
+
+/*====================================================
+
+  Abs:  Ideal linear calibration of a raw value
+
+  Name: drvHy8413_bench_ideal
+
+  Args: pts_a                           Calibration points
+          Type: array                   Note: 5 elements,
+          Use:  unsigned short const * const  offset binary
+          Acc:  read-only
+          Mech: By reference
+
+        calType                         Calibration type
+          Type: integer                 Note: 1 = 3-point
+          Use:  unsigned short                2 = 5-point
+          Acc:  read-only
+          Mech: By value
+
+        rval                            Raw data value
+          Type: integer                 Note: offset binary
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function interpolates the raw value between the
+       calibration points used by the calibration type, onto
+       the nominal codes of the points. The outer segments are
+       extended past the full scale points.
+
+  Side: None
+
+  Ret:  double
+             ideal calibrated value, 0 to 65535
+
+=======================================================*/
+static double drvHy8413_bench_ideal( unsigned short const * const pts_a,
+                                     unsigned short               calType,
+                                     unsigned short               rval )
+{
+  unsigned short i;
+  unsigned short n;
+  unsigned short idx_a[MAX_CAL_PTS] = {0,1,2,3,4};
+  double         x0, x1, y0, y1;
+  double         dval;
+
+  if ( calType == factor_3pt )
+  {
+    idx_a[1] = 2;
+    idx_a[2] = 4;
+    n = 3;
+  }
+  else
+    n = MAX_CAL_PTS;
+
+  /* Segment of the raw value, the outer ones extended */
+  for (i=1; i<n-1; i++)
+    if ( rval < pts_a[idx_a[i]] ) break;
+  x0 = pts_a[idx_a[i-1]];
+  x1 = pts_a[idx_a[i]];
+  y0 = nom_a[idx_a[i-1]];
+  y1 = nom_a[idx_a[i]];
+  dval = y0 + ((double)rval - x0)*(y1 - y0)/(x1 - x0);
+
+  if ( dval > 65535.0 )
+    dval = 65535.0;
+  else if ( dval < 0.0 )
+    dval = 0.0;
+  return( dval );
+}
+
+/*====================================================
+
+  Abs:  Load the calibration points of one case
+
+  Name: drvHy8413_bench_set
+
+  Args: bench_ps                        Scratch card information
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        card_ps                         Card information
+          Type: pointer                 Note: NULL for synthetic
+          Use:  IPADC_ID                      points
+          Acc:  read-only
+          Mech: By reference
+
+        range                           Voltage range
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function copies the calibration points of the
+       range to the scratch card in both data formats, as
+       drvHy8413_cal_range() does, and sets up the fixed-point
+       segments and the tables for the data format and
+       calibration type of the scratch card. The synthetic
+       points move by up to +/-512 counts from nominal, clipped
+       to 0..65535, with a different set for each range. Channels with coincident
+       points are not calibrated.
+
+  Side: The tables are allocated the first time.
+
+  Ret:  unsigned short
+             Number of calibrated channels
+
+=======================================================*/
+static unsigned short drvHy8413_bench_set( IPADC_ID       bench_ps,
+                                           IPADC_ID       card_ps,
+                                           unsigned short range )
+{
+  unsigned short       c;
+  unsigned short       k;
+  unsigned short       j;
+  unsigned short       n      = 0;
+  unsigned short       val;
+  long                 pt;
+  unsigned long        seed   = 12345 + range;
+  hytec_ipmCalChan_ts *cal_ps;
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps       = &bench_ps->cal_s.chan_as[c];
+    cal_ps->enb  = 1;
+    cal_ps->init = 1;
+    for (k=0; k<MAX_CAL_PTS; k++)
+    {
+      if ( card_ps )
+        val = card_ps->cal_s.chan_as[c].rng_a[range][k];
+      else
+      {
+        seed = seed * 1103515245UL + 12345UL;
+        pt   = (long)nom_a[k] + (long)((seed >> 16) & 0x3ff) - 0x200;
+        if ( pt < 0 )          pt = 0;
+        else if ( pt > 65535 ) pt = 65535;
+        val  = (unsigned short)pt;
+      }
+      cal_ps->gain_a[offset_binary][k]   = val;
+      cal_ps->gain_a[twos_compliment][k] = val & TWOS_COMPLIMENT_MAX;
+    }
+    if ( card_ps && !(card_ps->cal_s.chan_as[c].rngInit & (1 << range)) )
+      cal_ps->init = 0;
+    for (k=0; k<MAX_CAL_PTS; k++)
+      for (j=k+1; j<MAX_CAL_PTS; j++)
+        if ( (cal_ps->gain_a[offset_binary][k]   == cal_ps->gain_a[offset_binary][j]) ||
+             (cal_ps->gain_a[twos_compliment][k] == cal_ps->gain_a[twos_compliment][j]) )
+          cal_ps->init = 0;
+    if ( cal_ps->init ) n++;
+  }
+  bench_ps->range       = range;
+  bench_ps->cal_s.range = range;
+  drvHy8413_cal_fix_build( bench_ps );
+  drvHy8413_cal_lut_build( bench_ps );
+  return( n );
+}
+
+/*====================================================
+
+  Abs:  Check and time the calibration of one case
+
+  Name: drvHy8413_bench_case
+
+  Args: bench_ps                        Scratch card information
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        raw_a                           Raw values 0 to 65535
+          Type: array
+          Use:  unsigned short const *
+          Acc:  read-only
+          Mech: By reference
+
+        out_a                           Block output
+          Type: array                   Note: HY8413_BENCH_NRAW
+          Use:  unsigned short *              elements
+          Acc:  write-only
+          Mech: By reference
+
+        nloop                           Timing passes
+          Type: integer
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+        dcal_p                          Largest deviation
+          Type: pointer                 Note: counts, raised to
+          Use:  double *                      that of this case
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function sweeps all raw values of the calibrated
+       channels of the scratch card, in its current format,
+       range and calibration type, and prints the deviations,
+       mismatches and times of the case on one line.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - All faster paths match drvHy8413_cal_adc()
+             ERROR - Mismatch found
+
+=======================================================*/
+static long drvHy8413_bench_case( IPADC_ID               bench_ps,
+                                  unsigned short const * raw_a,
+                                  unsigned short       * out_a,
+                                  int                    nloop,
+                                  double               * dcal_p )
+{
+  int                  i;
+  unsigned short       c;
+  unsigned long        j;
+  unsigned short       ob;
+  unsigned short       nchan   = 0;
+  unsigned short       rmax    = 0;
+  unsigned short       cmax    = 0;
+  unsigned long        nbad_a[4] = {0,0,0,0};
+  long                 ref;
+  volatile long        sink    = 0;
+  double               ideal;
+  double               dev;
+  double               egu;
+  double               dcal    = 0.0;
+  double               draw    = 0.0;
+  double               nsamp;
+  double               dt_a[4] = {0.0,0.0,0.0,0.0};
+  epicsTimeStamp       t0,t1;
+  hytec_ipmCalChan_ts *cal_ps;
+  hytec_ipmCalEgu_ts   egu_s;
+  unsigned short const *pts_a;
+  static const char   *format_ac[2] = {"2C","OB"};
+  static const char   *type_ac[3]   = {"none","3pt","5pt"};
+
+  /* Accuracy and mismatches */
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps = &bench_ps->cal_s.chan_as[c];
+    if ( !cal_ps->init ) continue;
+    nchan++;
+    pts_a = &cal_ps->gain_a[offset_binary][0];
+    drvHy8413_cal_egu_set( bench_ps, c, 0.0, 65535.0, &egu_s );
+
+    bench_ps->cal_s.lut = 0;
+    drvHy8413_cal_chan_blk( bench_ps, c, raw_a, out_a, HY8413_BENCH_NRAW );
+    bench_ps->cal_s.lut = 1;
+    for (j=0; j<HY8413_BENCH_NRAW; j++)
+    {
+      ref = drvHy8413_cal_adc( &cal_ps->gain_a[bench_ps->format][0],
+                               bench_ps->cal_s.type,
+                               bench_ps->format,
+                               (long)j );
+      ob  = (bench_ps->format == offset_binary) ? (unsigned short)j : (unsigned short)(j ^ 0x8000);
+      ideal = drvHy8413_bench_ideal( pts_a, bench_ps->cal_s.type, ob );
+      dev = fabs( (double)ref - ideal );
+      if ( dev > dcal )
+      {
+        dcal = dev;
+        rmax = (unsigned short)j;
+        cmax = c;
+      }
+      dev = fabs( (double)ob - ideal );
+      if ( dev > draw ) draw = dev;
+
+      if ( drvHy8413_cal_fix( &bench_ps->cal_s.fix_as[c], bench_ps->cal_s.type, (long)j ) != ref )
+        nbad_a[0]++;
+      if ( bench_ps->cal_s.lut_a[c][j] != ref )
+        nbad_a[1]++;
+      if ( out_a[j] != ref )
+        nbad_a[2]++;
+
+      /* EGU of one per count, not truncated */
+      egu = drvHy8413_cal_egu( bench_ps, c, &egu_s, (unsigned short)j );
+      if ( (egu < (double)ref - HY8413_BENCH_EGUTOL) ||
+           (egu > (double)ref + 1.0 + HY8413_BENCH_EGUTOL) )
+        nbad_a[3]++;
+    }
+  }
+  if ( !nchan )
+  {
+    printf("\t%s %3s  +/-%2dV  no calibrated channel\n",
+           format_ac[bench_ps->format],
+           type_ac[bench_ps->cal_s.type],
+           (bench_ps->range == five_plus_minus) ? 5 : 10 );
+    return( OK );
+  }
+
+  /* Time per sample, calibrated channels only */
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      cal_ps = &bench_ps->cal_s.chan_as[c];
+      if ( !cal_ps->init ) continue;
+      for (j=0; j<HY8413_BENCH_NRAW; j++)
+        sink += drvHy8413_cal_adc( &cal_ps->gain_a[bench_ps->format][0],
+                                   bench_ps->cal_s.type,
+                                   bench_ps->format,
+                                   raw_a[j] );
+    }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[0] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      if ( !bench_ps->cal_s.chan_as[c].init ) continue;
+      for (j=0; j<HY8413_BENCH_NRAW; j++)
+        sink += drvHy8413_cal_fix( &bench_ps->cal_s.fix_as[c], bench_ps->cal_s.type, raw_a[j] );
+    }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[1] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      if ( !bench_ps->cal_s.chan_as[c].init ) continue;
+      for (j=0; j<HY8413_BENCH_NRAW; j++)
+        sink += drvHy8413_cal_val( bench_ps, c, raw_a[j] );
+    }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[2] = epicsTimeDiffInSeconds( &t1, &t0 );
+
+  bench_ps->cal_s.lut = 0;
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      if ( !bench_ps->cal_s.chan_as[c].init ) continue;
+      drvHy8413_cal_chan_blk( bench_ps, c, raw_a, out_a, HY8413_BENCH_NRAW );
+      sink += out_a[i];
+    }
+  epicsTimeGetCurrent( &t1 );
+  dt_a[3] = epicsTimeDiffInSeconds( &t1, &t0 );
+  bench_ps->cal_s.lut = 1;
+
+  if ( dcal > *dcal_p ) *dcal_p = dcal;
+  nsamp = (double)nloop * nchan * HY8413_BENCH_NRAW;
+  printf("\t%s %3s  +/-%2dV  %2hu  %8.1f %8.1f  %04hx/%-2hu  %7lu %7lu %7lu %7lu  %6.1f %6.1f %6.1f %6.1f\n",
+         format_ac[bench_ps->format],
+         type_ac[bench_ps->cal_s.type],
+         (bench_ps->range == five_plus_minus) ? 5 : 10,
+         nchan,
+         draw,
+         dcal,
+         rmax,
+         cmax,
+         nbad_a[0],
+         nbad_a[1],
+         nbad_a[2],
+         nbad_a[3],
+         dt_a[0]*1.0e9/nsamp,
+         dt_a[1]*1.0e9/nsamp,
+         dt_a[2]*1.0e9/nsamp,
+         dt_a[3]*1.0e9/nsamp );
+  return( (nbad_a[0] || nbad_a[1] || nbad_a[2] || nbad_a[3]) ? ERROR : OK );
+}
+
+/*====================================================
+
+  Abs:  Calibration accuracy and throughput suite
+
+  Name: drvHy8413_cal_bench
+
+  Args: name_c                          Card name
+          Type: char-string             Note: NULL or "" for
+          Use:  char const *                  synthetic points
+          Acc:  read-only
+          Mech: By reference
+
+        nloop                           Timing passes
+          Type: integer                 Note: default 1, of
+          Use:  int                           65536 samples per
+          Acc:  read-only                     channel each
+          Mech: By value
+
+        dev_a                           Largest deviations
+          Type: array                   Note: 2 elements, by
+          Use:  double * const                data format, or NULL
+          Acc:  write-only
+          Mech: By reference
+
+  Rem:  This function runs the 8 cases, both data formats,
+        both ranges and both calibration types, on the points
+        of the card or on synthetic points, and prints one line
+        per case:
+
+          fmt type range  chans  raw-dev cal-dev  at raw/chan
+              mismatches fix lut blk egu  ns/sample double fix lut blk
+
+        raw-dev and cal-dev are the largest deviations in counts
+        of the raw value and of drvHy8413_cal_adc() from the
+        ideal linear calibration. fix, lut and blk are the
+        fixed-point segments, the tables and the block
+        calibration, their mismatches are against
+        drvHy8413_cal_adc(). egu is drvHy8413_cal_egu() at one
+        EGU per count, a mismatch when it is not between the
+        result of drvHy8413_cal_adc() and the next count. The
+        largest cal-dev of each data format is returned in
+        dev_a, indexed by format, so that a test can hold it
+        to a tolerance.
+
+  Side: Report is sent to the standard output device. About
+        2 Mbytes are allocated for the run.
+
+  Ret:  long
+             OK    - All faster paths match drvHy8413_cal_adc()
+             ERROR - Mismatch found, card not found or out of memory
+
+=======================================================*/
+long drvHy8413_cal_bench( char const *   name_c,
+                          int            nloop,
+                          double * const dev_a )
+{
+  long                status  = OK;
+  double              dcal_a[2] = {0.0,0.0};
+  unsigned short      f;
+  unsigned short      r;
+  unsigned short      t;
+  unsigned short      c;
+  unsigned long       j;
+  unsigned short     *raw_a   = NULL;
+  unsigned short     *out_a   = NULL;
+  IPADC_ID            card_ps = NULL;
+  IPADC_ID            bench_ps;
+  static const unsigned short calType_a[2] = {factor_3pt,factor_5pt};
+  static const unsigned short format_a[2]  = {offset_binary,twos_compliment};
+
+  if ( dev_a )
+  {
+    dev_a[0] = 0.0;
+    dev_a[1] = 0.0;
+  }
+  if ( name_c && name_c[0] )
+  {
+    card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+    if ( !card_ps )
+    {
+       errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+       return( ERROR );
+    }
+    if ( card_ps->cal_s.type == nocal )
+    {
+       errlogPrintf("IP8413: No calibration data on card %s\n",name_c);
+       return( ERROR );
+    }
+  }
+  if ( nloop <= 0 ) nloop = 1;
+
+  bench_ps = calloc( 1, sizeof(*bench_ps) );
+  raw_a    = calloc( HY8413_BENCH_NRAW, sizeof(unsigned short) );
+  out_a    = calloc( HY8413_BENCH_NRAW, sizeof(unsigned short) );
+  if ( !bench_ps || !raw_a || !out_a )
+  {
+    errlogPrintf("IP8413: ip8413CalBench() out of memory\n");
+    if ( bench_ps ) free( bench_ps );
+    if ( raw_a )    free( raw_a );
+    if ( out_a )    free( out_a );
+    return( ERROR );
+  }
+  for (j=0; j<HY8413_BENCH_NRAW; j++)
+    raw_a[j] = (unsigned short)j;
+  bench_ps->cal_s.enb = 1;
+
+  printf("IP8413 calibration benchmark (%s points), %d pass(es)\n",
+         card_ps ? name_c : "synthetic", nloop );
+  printf("\tfmt typ  range  ch   raw-dev  cal-dev  at raw/ch   mismatch fix/lut/blk/egu        ns/sample double/fix/lut/blk\n");
+  for (f=0; f<2; f++)
+    for (r=0; r<NUM_RANGES; r++)
+      for (t=0; t<2; t++)
+      {
+        bench_ps->format     = format_a[f];
+        bench_ps->cal_s.type = calType_a[t];
+        drvHy8413_bench_set( bench_ps, card_ps, r );
+        if ( drvHy8413_bench_case( bench_ps, raw_a, out_a, nloop,
+                                   &dcal_a[bench_ps->format] ) != OK )
+          status = ERROR;
+      }
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    if ( bench_ps->cal_s.lut_a[c] )     free( bench_ps->cal_s.lut_a[c] );
+    if ( bench_ps->cal_s.lutNext_a[c] ) free( bench_ps->cal_s.lutNext_a[c] );
+  }
+  free( bench_ps );
+  free( raw_a );
+  free( out_a );
+  if ( dev_a )
+  {
+    dev_a[0] = dcal_a[0];
+    dev_a[1] = dcal_a[1];
+  }
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Calibration accuracy and throughput suite (shell)
+
+  Name: ip8413CalBench
+
+  Args: name_c                          Card name
+          Type: char-string             Note: NULL or "" for
+          Use:  char const *                  synthetic points
+          Acc:  read-only
+          Mech: By reference
+
+        nloop                           Timing passes
+          Type: integer                 Note: default 1, of
+          Use:  int                           65536 samples per
+          Acc:  read-only                     channel each
+          Mech: By value
+
+  Rem:  This function runs drvHy8413_cal_bench() from the
+        shell. For example:
+
+            ip8413CalBench(0,1)
+            ip8413CalBench("ADC0",4)
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - All faster paths match drvHy8413_cal_adc()
+             ERROR - Mismatch found, card not found or out of memory
+
+=======================================================*/
+long ip8413CalBench( char const * name_c, int nloop )
+{
+  return( drvHy8413_cal_bench( name_c, nloop, NULL ) );
+}
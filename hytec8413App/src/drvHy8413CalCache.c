@@ -0,0 +1,614 @@
+/*
+=============================================================
+
+  Abs:  Calibration data cache for VME Hytec ip-adc-8413 modules
+
+  Name: drvHy8413CalCache.c
+          *  drvHy8413_cache_sum    - Checksum of the id prom of a card
+          *  drvHy8413_cache_find   - Find the cache entry of a module
+          *  drvHy8413_cache_chk    - Compare a cache entry with the id prom
+          *  drvHy8413_cache_wt     - Write the cache file
+             drvHy8413_cache_ld     - Load the calibration data of a card from the cache
+             drvHy8413_cache_save   - Save the calibration data of a card in the cache
+             drvHy8413_cache_flush  - Write the cache file if it changed
+             ip8413CalCache         - Read the cache file (shell)
+
+          * indicates static routines
+
+  Rem:  Reading the calibration data from the id prom means
+        paging through it with the ACR, with a readback of
+        each page, for every card at startup. The calibration
+        data of each module is kept in a text file instead,
+        keyed by the serial number, the revision and a checksum
+        of page 0 of the id prom, the range and the calibration
+        type. Page 0 is mapped when the card is created, so the
+        key costs no paging.
+
+        Recalibrating a module rewrites its calibration pages
+        but need not change page 0, so on a match the first
+        calibration page of the range, channels 0 to 5, is
+        still read and compared with the entry. If it differs
+        a warning is printed, and the module is treated as not
+        cached. When there is no match, the pages of the range
+        are read from the id prom and saved in the cache. A hit
+        thus reads one page of the three of each range.
+
+        The file is written once, from drvHy8413_init_driver()
+        during iocInit, and only if an entry was added or
+        changed. It is written to <file>.tmp first and then
+        renamed over the cache, so a crash or power loss while
+        writing leaves the old cache in place.
+
+        The file is read by ip8413CalCache(), which must be
+        called before the cards are created, for example:
+
+            ip8413CalCache("/data/hy8413cal.txt")
+
+        Each line holds the 5 calibration points of one channel
+        in offset binary, as in the id prom:
+
+            # serial rev idsum range type chan nFS nHS zero pHS pFS
+            0x0123 0x0002 0x5a3c 0 2 0 0x0012 0x400a 0x8001 0xbff6 0xffef
+
+        An entry is used only when all 16 channels are present.
+        Lines of the older format without the checksum are
+        counted invalid, so those modules are read again.
+        The cache is only used during startup and is not locked.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsString.h"
+#include "ellLib.h"
+#include "errlog.h"
+#include "cantProceed.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+#define HY8413_CACHE_ALLCHAN  ((1UL << HY8413_NUM_CHAN) - 1)
+
+/* Calibration data of one module in one range */
+typedef struct hy8413_cacheEnt_s
+{
+   ELLNODE         node;
+   unsigned short  serialNo;
+   unsigned short  rev;
+   unsigned short  idSum;            /* checksum of id prom page 0 */
+   unsigned short  range;
+   unsigned short  type;
+   unsigned long   chanMask;         /* channels present */
+   unsigned short  gain_a[MAX_CHAN][MAX_CAL_PTS];
+} hy8413_cacheEnt_ts;
+
+static ELLLIST  cacheList_s = {{ NULL,NULL },0};
+static char    *cachePath_c = NULL;
+static int      cacheDirty   = 0;    /* entries changed since the file was read */
+
+/* Local Prototypes */
+static unsigned short drvHy8413_cache_sum( IPADC_ID const card_ps );
+static hy8413_cacheEnt_ts *drvHy8413_cache_find( unsigned short serialNo,
+                                                 unsigned short rev,
+                                                 unsigned short idSum,
+                                                 unsigned short range,
+                                                 unsigned short type );
+static long drvHy8413_cache_chk( IPADC_ID                   card_ps,
+                                 hy8413_cacheEnt_ts const * ent_ps,
+                                 unsigned short             range );
+static long drvHy8413_cache_wt( void );
+
+
+/*====================================================
+
+  Abs:  Checksum of the id prom of a card
+
+  Name: drvHy8413_cache_sum
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem: This function returns a Fletcher checksum of the id
+       prom words in view, which must be page 0.
+
+  Side: None
+
+  Ret:  unsigned short
+             Checksum
+
+=======================================================*/
+static unsigned short drvHy8413_cache_sum( IPADC_ID const card_ps )
+{
+  unsigned short i;
+  unsigned long  s1 = 0;
+  unsigned long  s2 = 0;
+
+  for (i=0; i<IPAC_ID_SPACE_WCNT; i++)
+  {
+    s1 = (s1 + card_ps->id_pu->_a[i]) % 255;
+    s2 = (s2 + s1) % 255;
+  }
+  return( (unsigned short)((s2 << 8) | s1) );
+}
+
+
+/*====================================================
+
+  Abs:  Find the cache entry of a module
+
+  Name: drvHy8413_cache_find
+
+  Args: serialNo                        Serial number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        rev                             Revision
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        idSum                           Id prom checksum
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        range                           Voltage range
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        type                            Calibration type
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function looks up the cache entry with this key.
+
+  Side: None
+
+  Ret:  hy8413_cacheEnt_ts *
+             Cache entry, or NULL if none
+
+=======================================================*/
+static hy8413_cacheEnt_ts *drvHy8413_cache_find( unsigned short serialNo,
+                                                 unsigned short rev,
+                                                 unsigned short idSum,
+                                                 unsigned short range,
+                                                 unsigned short type )
+{
+  hy8413_cacheEnt_ts *ent_ps;
+
+  for (ent_ps = (hy8413_cacheEnt_ts *)ellFirst( &cacheList_s );
+       ent_ps;
+       ent_ps = (hy8413_cacheEnt_ts *)ellNext( &ent_ps->node ))
+  {
+    if ( (ent_ps->serialNo == serialNo) && (ent_ps->rev   == rev)   &&
+         (ent_ps->idSum    == idSum)    && (ent_ps->range == range) &&
+         (ent_ps->type     == type) )
+      return( ent_ps );
+  }
+  return( NULL );
+}
+
+/*====================================================
+
+  Abs:  Compare a cache entry with the id prom
+
+  Name: drvHy8413_cache_chk
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-only
+          Mech: By reference
+
+        ent_ps                          Cache entry
+          Type: pointer
+          Use:  hy8413_cacheEnt_ts const *
+          Acc:  read-only
+          Mech: By reference
+
+        range                           Voltage range
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function reads the first calibration page of the
+       range and compares the points of its channels with the
+       cache entry, which catches a module recalibrated since
+       the entry was saved.
+
+  Side: The id prom is paged, and is left on page 0.
+
+  Ret:  long
+             OK    - Entry matches the id prom
+             ERROR - Entry is stale or the page could not be set
+
+=======================================================*/
+static long drvHy8413_cache_chk( IPADC_ID                   card_ps,
+                                 hy8413_cacheEnt_ts const * ent_ps,
+                                 unsigned short             range )
+{
+  long                     status;
+  unsigned short           c;
+  unsigned short           i;
+  volatile unsigned short *id_a = card_ps->id_pu->_a;
+
+  status = drvHy8413_wt_page( card_ps->io_p, 1 + range*HY8413_NUM_PG );
+  for (c=0; (c<HY8413_MAX_PG_CHAN) && (status==OK); c++)
+    for (i=0; i<MAX_CAL_PTS; i++)
+      if ( id_a[c*MAX_CAL_PTS + i] != ent_ps->gain_a[c][i] )
+      {
+        errlogPrintf("IP8413: Cached calibration of card %s range %hu is stale, reading id prom\n",
+                     card_ps->name_c, range);
+        status = ERROR;
+        break;
+      }
+  drvHy8413_wt_page( card_ps->io_p, 0 );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Write the cache file
+
+  Name: drvHy8413_cache_wt
+
+  Args: None
+
+  Rem: This function writes all cache entries to a
+       temporary file, <file>.tmp, and renames it over the
+       cache file, so that the cache is replaced whole or
+       not at all.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - File could not be written
+
+=======================================================*/
+static long drvHy8413_cache_wt( void )
+{
+  long                status = OK;
+  unsigned short      c;
+  char               *tmp_c;
+  FILE               *fp;
+  hy8413_cacheEnt_ts *ent_ps;
+
+  tmp_c = callocMustSucceed( 1, strlen(cachePath_c)+5, "drvHy8413_cache_wt()" );
+  strcpy( tmp_c, cachePath_c );
+  strcat( tmp_c, ".tmp" );
+  fp = fopen( tmp_c, "w" );
+  if ( !fp )
+  {
+    errlogPrintf("IP8413: Unable to write calibration cache %s\n",tmp_c);
+    free( tmp_c );
+    return( ERROR );
+  }
+  fprintf(fp,"# Hytec IP-ADC-8413 calibration cache, written by drvHy8413\n");
+  fprintf(fp,"# serial rev idsum range type chan nFS nHS zero pHS pFS\n");
+  for (ent_ps = (hy8413_cacheEnt_ts *)ellFirst( &cacheList_s );
+       ent_ps;
+       ent_ps = (hy8413_cacheEnt_ts *)ellNext( &ent_ps->node ))
+  {
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      if ( !(ent_ps->chanMask & (1UL << c)) ) continue;
+      fprintf(fp,"0x%04hx 0x%04hx 0x%04hx %hu %hu %2hu 0x%04hx 0x%04hx 0x%04hx 0x%04hx 0x%04hx\n",
+              ent_ps->serialNo,
+              ent_ps->rev,
+              ent_ps->idSum,
+              ent_ps->range,
+              ent_ps->type,
+              c,
+              ent_ps->gain_a[c][0],
+              ent_ps->gain_a[c][1],
+              ent_ps->gain_a[c][2],
+              ent_ps->gain_a[c][3],
+              ent_ps->gain_a[c][4] );
+    }
+  }
+  if ( fflush(fp) || ferror(fp) ) status = ERROR;
+  if ( fclose(fp) ) status = ERROR;
+  if ( status != OK )
+  {
+    errlogPrintf("IP8413: Error writing calibration cache %s\n",tmp_c);
+    remove( tmp_c );
+  }
+  else if ( rename( tmp_c, cachePath_c ) )
+  {
+    errlogPrintf("IP8413: Unable to replace calibration cache %s\n",cachePath_c);
+    remove( tmp_c );
+    status = ERROR;
+  }
+  free( tmp_c );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Load the calibration data of a card from the cache
+
+  Name: drvHy8413_cache_ld
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        range                           Voltage range
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function copies the cached calibration data of
+       the module, for its serial number, revision, id prom
+       checksum and calibration type, into the calibration data of the
+       range, as drvHy8413_rd_cal_page() does, once the entry
+       matches the first calibration page of the range.
+
+  Side: The id prom must be on page 0, and is left on page 0.
+
+  Ret:  long
+             OK    - Calibration data loaded
+             ERROR - No cache or no complete entry for the module
+
+=======================================================*/
+long drvHy8413_cache_ld( void * const card_p, unsigned short range )
+{
+  unsigned short       c;
+  unsigned short       i;
+  hy8413_cacheEnt_ts  *ent_ps;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+
+  if ( !cachePath_c ) return( ERROR );
+
+  ent_ps = drvHy8413_cache_find( card_ps->serialNo,
+                                 card_ps->rev,
+                                 drvHy8413_cache_sum( card_ps ),
+                                 range,
+                                 card_ps->cal_s.type );
+  if ( !ent_ps || (ent_ps->chanMask != HY8413_CACHE_ALLCHAN) ) return( ERROR );
+  if ( drvHy8413_cache_chk( card_ps, ent_ps, range ) != OK ) return( ERROR );
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps           = &card_ps->cal_s.chan_as[c];
+    cal_ps->rngInit |= 1 << range;
+    cal_ps->enb      = 1;
+    for (i=0; i<MAX_CAL_PTS; i++)
+      cal_ps->rng_a[range][i] = ent_ps->gain_a[c][i];
+  }
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Save the calibration data of a card in the cache
+
+  Name: drvHy8413_cache_save
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+        range                           Voltage range
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function stores the calibration data of the card
+       for the range, as read from the id prom, in the cache
+       entry of the module, replacing any entry with an older
+       id prom checksum. The file is written later, once,
+       by drvHy8413_cache_flush().
+
+  Side: The id prom must be on page 0.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - No cache
+
+=======================================================*/
+long drvHy8413_cache_save( void const * const card_p, unsigned short range )
+{
+  unsigned short             c;
+  unsigned short             idSum;
+  hy8413_cacheEnt_ts        *ent_ps;
+  hy8413_cacheEnt_ts        *next_ps;
+  hytec_ipmCalChan_ts const *cal_ps;
+  IPADC_ID                   card_ps = (IPADC_ID)card_p;
+
+  if ( !cachePath_c ) return( ERROR );
+
+  idSum  = drvHy8413_cache_sum( card_ps );
+
+  /* Drop the data of the module from before its id prom changed */
+  for (ent_ps = (hy8413_cacheEnt_ts *)ellFirst( &cacheList_s ); ent_ps; ent_ps = next_ps)
+  {
+    next_ps = (hy8413_cacheEnt_ts *)ellNext( &ent_ps->node );
+    if ( (ent_ps->serialNo == card_ps->serialNo) && (ent_ps->rev   == card_ps->rev) &&
+         (ent_ps->idSum    != idSum)             && (ent_ps->range == range)        &&
+         (ent_ps->type     == card_ps->cal_s.type) )
+    {
+      ellDelete( &cacheList_s, &ent_ps->node );
+      free( ent_ps );
+    }
+  }
+  ent_ps = drvHy8413_cache_find( card_ps->serialNo,
+                                 card_ps->rev,
+                                 idSum,
+                                 range,
+                                 card_ps->cal_s.type );
+  if ( !ent_ps )
+  {
+    ent_ps = callocMustSucceed( 1, sizeof(*ent_ps), "drvHy8413_cache_save()" );
+    ent_ps->serialNo = card_ps->serialNo;
+    ent_ps->rev      = card_ps->rev;
+    ent_ps->idSum    = idSum;
+    ent_ps->range    = range;
+    ent_ps->type     = card_ps->cal_s.type;
+    ellAdd( &cacheList_s, &ent_ps->node );
+  }
+  ent_ps->chanMask = 0;
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    if ( !(cal_ps->rngInit & (1 << range)) ) continue;
+    memcpy( ent_ps->gain_a[c], cal_ps->rng_a[range], sizeof(ent_ps->gain_a[c]) );
+    ent_ps->chanMask |= 1UL << c;
+  }
+  cacheDirty = 1;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Write the cache file if it changed
+
+  Name: drvHy8413_cache_flush
+
+  Args: None
+
+  Rem: This function writes the cache file if entries were
+       saved since it was read. It is called once, during
+       iocInit, after all cards were created.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation or nothing to write
+             ERROR - File could not be written
+
+=======================================================*/
+long drvHy8413_cache_flush( void )
+{
+  long status;
+
+  if ( !cachePath_c || !cacheDirty ) return( OK );
+  status = drvHy8413_cache_wt();
+  if ( status == OK ) cacheDirty = 0;
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Read the cache file (shell)
+
+  Name: ip8413CalCache
+
+  Args: path_c                          Cache file name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  This function sets the calibration cache file and reads
+        its entries. A missing file is not an error: it is
+        created when the first card is read from its id prom.
+        Must be called before ip8413Create().
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid file name
+
+=======================================================*/
+long ip8413CalCache( char const * const path_c )
+{
+  unsigned short      i;
+  unsigned long       nline = 0;
+  unsigned long       nbad  = 0;
+  int                 v_a[6+MAX_CAL_PTS];
+  char                line_c[128];
+  FILE               *fp;
+  hy8413_cacheEnt_ts *ent_ps;
+
+  if ( !path_c || !path_c[0] )
+  {
+    errlogPrintf("IP8413: No calibration cache file given\n");
+    return( ERROR );
+  }
+  if ( cachePath_c ) free( cachePath_c );
+  cachePath_c = epicsStrDup( path_c );
+
+  fp = fopen( cachePath_c, "r" );
+  if ( !fp )
+  {
+    printf("IP8413: Calibration cache %s not found, it will be created\n",cachePath_c);
+    return( OK );
+  }
+  while ( fgets( line_c, sizeof(line_c), fp ) )
+  {
+    if ( (line_c[0] == '#') || (line_c[0] == '\n') ) continue;
+    nline++;
+    if ( (sscanf( line_c, "%i %i %i %i %i %i %i %i %i %i %i",
+                  &v_a[0], &v_a[1], &v_a[2], &v_a[3], &v_a[4], &v_a[5],
+                  &v_a[6], &v_a[7], &v_a[8], &v_a[9], &v_a[10] ) != 6+MAX_CAL_PTS) ||
+         (v_a[3] < 0) || (v_a[3] > five_plus_minus) ||
+         (v_a[4] < 0) || (v_a[4] >= NUM_CAL_TYPES) ||
+         (v_a[5] < 0) || (v_a[5] >= HY8413_NUM_CHAN) )
+    {
+      nbad++;
+      continue;
+    }
+    ent_ps = drvHy8413_cache_find( v_a[0], v_a[1], v_a[2], v_a[3], v_a[4] );
+    if ( !ent_ps )
+    {
+      ent_ps = callocMustSucceed( 1, sizeof(*ent_ps), "ip8413CalCache()" );
+      ent_ps->serialNo = v_a[0];
+      ent_ps->rev      = v_a[1];
+      ent_ps->idSum    = v_a[2];
+      ent_ps->range    = v_a[3];
+      ent_ps->type     = v_a[4];
+      ellAdd( &cacheList_s, &ent_ps->node );
+    }
+    for (i=0; i<MAX_CAL_PTS; i++)
+      ent_ps->gain_a[v_a[5]][i] = (unsigned short)v_a[6+i];
+    ent_ps->chanMask |= 1UL << v_a[5];
+  }
+  fclose( fp );
+  cacheDirty = 0;
+  if ( nbad )
+    errlogPrintf("IP8413: %lu invalid lines in calibration cache %s\n",nbad,cachePath_c);
+  printf("IP8413: Calibration cache %s: %lu channels, %d module ranges\n",
+         cachePath_c, nline-nbad, ellCount( &cacheList_s ) );
+  return( OK );
+}
@@ -0,0 +1,477 @@
+/*
+=============================================================
+
+  Abs:  FIFO sample deinterleave for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Deint.c
+             drvHy8413_deinterleave       - Split sample groups into channel arrays
+          *  drvHy8413_deint_tile         - Transpose one 8x8 block of samples
+             drvHy8413_deinterleave_naive - Reference per-sample deinterleave
+             drvHy8413_fifo_rd_all        - Copy the captured samples of all channels
+             ip8413DeintBench             - Benchmark the deinterleave (shell)
+
+          * indicates static routines
+
+  Rem:  The external FIFO holds groups of 16 samples, one per
+        channel. Splitting a full FIFO into 16 channel arrays
+        is a 16384x16 transpose, which is done here on 16x16
+        tiles of 8x8 blocks. On hosts with a vector unit
+        (AltiVec or SSE2) each block is transposed in registers
+        with three rounds of 16-bit merges, otherwise the same
+        tiling is done with scalar code.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/*
+ * Vector unit support. Each vector holds 8 samples, and
+ * the merges interleave the first (H) or last (L) four
+ * samples of two vectors, in memory order.
+ */
+#if defined(__ALTIVEC__)
+#include <altivec.h>
+#define HY8413_SIMD          "AltiVec"
+#define HY8413_VEC_ALIGN     0xf          /* vec_ld/vec_st need 16-byte alignment */
+typedef vector unsigned short hy8413_vec_t;
+#define VLOAD(p)             vec_ld( 0, (unsigned short *)(p) )
+#define VSTORE(p,v)          vec_st( (v), 0, (unsigned short *)(p) )
+#define VMERGEH(a,b)         vec_mergeh( (a), (b) )
+#define VMERGEL(a,b)         vec_mergel( (a), (b) )
+#define VXOR(a,b)            vec_xor( (a), (b) )
+#define VFLIP()              vec_sl( vec_splat_u16(1), vec_splat_u16(15) )
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define HY8413_SIMD          "SSE2"
+#define HY8413_VEC_ALIGN     0x0          /* unaligned loads and stores */
+typedef __m128i hy8413_vec_t;
+#define VLOAD(p)             _mm_loadu_si128( (__m128i const *)(p) )
+#define VSTORE(p,v)          _mm_storeu_si128( (__m128i *)(p), (v) )
+#define VMERGEH(a,b)         _mm_unpacklo_epi16( (a), (b) )
+#define VMERGEL(a,b)         _mm_unpackhi_epi16( (a), (b) )
+#define VXOR(a,b)            _mm_xor_si128( (a), (b) )
+#define VFLIP()              _mm_set1_epi16( (short)HY8413_2C_FLIP )
+#else
+#define HY8413_SIMD          "None"
+#endif
+
+#define HY8413_BLK           8            /* samples per vector, block size */
+#define HY8413_TILE          16           /* sample groups per tile         */
+
+
+#ifdef HY8413_VEC_ALIGN
+/*====================================================
+
+  Abs:  Transpose one 8x8 block of samples
+
+  Name: drvHy8413_deint_tile
+
+  Args: src_p                           First sample of block
+          Type: pointer                 Note: rows are sample
+          Use:  unsigned short const *        groups, 16 words apart
+          Acc:  read-only
+          Mech: By reference
+
+        dst_a                           Channel arrays
+          Type: array of pointers       Note: first channel of
+          Use:  unsigned short * const *      the block
+          Acc:  write-only
+          Mech: By reference
+
+        off                             Sample offset in arrays
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        flip                            Data format flip
+          Type: vector
+          Use:  hy8413_vec_t
+          Acc:  read-only
+          Mech: By value
+
+        xmask                           Apply the flip
+          Type: integer
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Rows are 8 consecutive sample groups of 8 channels,
+        columns are written to 8 consecutive samples of each
+        channel array.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_deint_tile( unsigned short const *        src_p,
+                                  unsigned short * const *      dst_a,
+                                  unsigned long                 off,
+                                  hy8413_vec_t                  flip,
+                                  int                           xmask )
+{
+  hy8413_vec_t a0,a1,a2,a3,a4,a5,a6,a7;
+  hy8413_vec_t b0,b1,b2,b3,b4,b5,b6,b7;
+  hy8413_vec_t c0,c1,c2,c3,c4,c5,c6,c7;
+
+  a0 = VLOAD( src_p + 0*HY8413_NUM_CHAN );
+  a1 = VLOAD( src_p + 1*HY8413_NUM_CHAN );
+  a2 = VLOAD( src_p + 2*HY8413_NUM_CHAN );
+  a3 = VLOAD( src_p + 3*HY8413_NUM_CHAN );
+  a4 = VLOAD( src_p + 4*HY8413_NUM_CHAN );
+  a5 = VLOAD( src_p + 5*HY8413_NUM_CHAN );
+  a6 = VLOAD( src_p + 6*HY8413_NUM_CHAN );
+  a7 = VLOAD( src_p + 7*HY8413_NUM_CHAN );
+
+  b0 = VMERGEH( a0, a4 );  b1 = VMERGEL( a0, a4 );
+  b2 = VMERGEH( a1, a5 );  b3 = VMERGEL( a1, a5 );
+  b4 = VMERGEH( a2, a6 );  b5 = VMERGEL( a2, a6 );
+  b6 = VMERGEH( a3, a7 );  b7 = VMERGEL( a3, a7 );
+
+  c0 = VMERGEH( b0, b4 );  c1 = VMERGEL( b0, b4 );
+  c2 = VMERGEH( b1, b5 );  c3 = VMERGEL( b1, b5 );
+  c4 = VMERGEH( b2, b6 );  c5 = VMERGEL( b2, b6 );
+  c6 = VMERGEH( b3, b7 );  c7 = VMERGEL( b3, b7 );
+
+  a0 = VMERGEH( c0, c4 );  a1 = VMERGEL( c0, c4 );
+  a2 = VMERGEH( c1, c5 );  a3 = VMERGEL( c1, c5 );
+  a4 = VMERGEH( c2, c6 );  a5 = VMERGEL( c2, c6 );
+  a6 = VMERGEH( c3, c7 );  a7 = VMERGEL( c3, c7 );
+
+  if ( xmask )
+  {
+    a0 = VXOR( a0, flip );  a1 = VXOR( a1, flip );
+    a2 = VXOR( a2, flip );  a3 = VXOR( a3, flip );
+    a4 = VXOR( a4, flip );  a5 = VXOR( a5, flip );
+    a6 = VXOR( a6, flip );  a7 = VXOR( a7, flip );
+  }
+
+  VSTORE( dst_a[0] + off, a0 );
+  VSTORE( dst_a[1] + off, a1 );
+  VSTORE( dst_a[2] + off, a2 );
+  VSTORE( dst_a[3] + off, a3 );
+  VSTORE( dst_a[4] + off, a4 );
+  VSTORE( dst_a[5] + off, a5 );
+  VSTORE( dst_a[6] + off, a6 );
+  VSTORE( dst_a[7] + off, a7 );
+  return;
+}
+#endif /* HY8413_VEC_ALIGN */
+
+/*====================================================
+
+  Abs:  Split sample groups into channel arrays
+
+  Name: drvHy8413_deinterleave
+
+  Args: src_a                           Sample groups
+          Type: array                   Note: 16 words per group
+          Use:  unsigned short const * const
+          Acc:  read-only
+          Mech: By reference
+
+        ngrp                            Number of sample groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        dst_a                           Channel arrays
+          Type: array of pointers       Note: 16 arrays of at
+          Use:  unsigned short * const *      least ngrp samples
+          Acc:  write-only
+          Mech: By reference
+
+        xmask                           Data format flip
+          Type: integer                 Note: 0 or HY8413_2C_FLIP
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function transposes the sample groups into one
+        array per channel, in tiles of 16 groups by 16 channels.
+        When xmask is HY8413_2C_FLIP every sample is converted
+        between two's complement and offset binary on the way.
+        The vector path is used when the vector unit is present
+        and the arrays meet its alignment, the remaining groups
+        are done by the scalar path.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_deinterleave( unsigned short const * const   src_a,
+                             unsigned long                  ngrp,
+                             unsigned short * const * const dst_a,
+                             unsigned short                 xmask )
+{
+  unsigned long         g    = 0;
+  unsigned long         t;
+  unsigned short        c;
+  unsigned short const *src_p;
+#ifdef HY8413_VEC_ALIGN
+  unsigned long         align = (unsigned long)src_a;
+  hy8413_vec_t          flip  = VFLIP();
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+    align |= (unsigned long)dst_a[c];
+  if ( !(align & HY8413_VEC_ALIGN) )
+  {
+    for (; (g+HY8413_TILE)<=ngrp; g+=HY8413_TILE)
+    {
+      src_p = &src_a[g*HY8413_NUM_CHAN];
+      drvHy8413_deint_tile( src_p,                                        dst_a,                g,               flip, xmask );
+      drvHy8413_deint_tile( src_p + HY8413_BLK,                           dst_a + HY8413_BLK,   g,               flip, xmask );
+      drvHy8413_deint_tile( src_p + HY8413_BLK*HY8413_NUM_CHAN,            dst_a,                g + HY8413_BLK,  flip, xmask );
+      drvHy8413_deint_tile( src_p + HY8413_BLK*HY8413_NUM_CHAN+HY8413_BLK, dst_a + HY8413_BLK,   g + HY8413_BLK,  flip, xmask );
+    }
+  }
+#endif
+
+  /* Scalar tiles, one channel at a time across the tile */
+  for (; g<ngrp; g+=HY8413_TILE)
+  {
+    t = MIN( HY8413_TILE, ngrp - g );
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      unsigned short       *dst_p = dst_a[c] + g;
+      unsigned long         i;
+
+      src_p = &src_a[g*HY8413_NUM_CHAN + c];
+      for (i=0; i<t; i++, src_p+=HY8413_NUM_CHAN)
+        dst_p[i] = *src_p ^ xmask;
+    }
+  }
+  return;
+}
+
+/*====================================================
+
+  Abs:  Reference per-sample deinterleave
+
+  Name: drvHy8413_deinterleave_naive
+
+  Args: See drvHy8413_deinterleave()
+
+  Rem:  This function walks the sample groups once per
+        channel, as the waveform readout does. It is kept
+        as the reference for the benchmark.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_deinterleave_naive( unsigned short const * const   src_a,
+                                   unsigned long                  ngrp,
+                                   unsigned short * const * const dst_a,
+                                   unsigned short                 xmask )
+{
+  unsigned long  g;
+  unsigned short c;
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+    for (g=0; g<ngrp; g++)
+      dst_a[c][g] = src_a[g*HY8413_NUM_CHAN + c] ^ xmask;
+  return;
+}
+
+/*====================================================
+
+  Abs:  Copy the captured samples of all channels
+
+  Name: drvHy8413_fifo_rd_all
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        dst_a                           Channel arrays
+          Type: array of pointers       Note: 16 arrays of at
+          Use:  unsigned short * const *      least nelm samples
+          Acc:  write-only
+          Mech: By reference
+
+        nelm                            Size of channel arrays
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        xmask                           Data format flip
+          Type: integer                 Note: 0 or HY8413_2C_FLIP
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function deinterleaves the most recent captured
+        sample groups into one array per channel, oldest first.
+        The card buffer is a ring, so this is done in at most
+        two runs of contiguous groups.
+
+  Side: The card lock is taken while copying.
+
+  Ret:  unsigned long
+             Number of samples copied per channel
+
+=======================================================*/
+unsigned long drvHy8413_fifo_rd_all( void * const                   card_p,
+                                     unsigned short * const * const dst_a,
+                                     unsigned long                  nelm,
+                                     unsigned short                 xmask )
+{
+  unsigned long         n;
+  unsigned long         n1;
+  unsigned long         pos;
+  unsigned long         maxgrp;
+  unsigned short        c;
+  unsigned short       *dst2_a[HY8413_NUM_CHAN];
+  IPADC_ID              card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->fifo_s.buf_a )
+     return( 0 );
+
+  epicsMutexMustLock( card_ps->lock );
+  maxgrp = card_ps->fifo_s.maxgrp;
+  n      = MIN( card_ps->fifo_s.nbuf, nelm );
+  pos    = drvHy8413_fifo_oldest( card_ps, n );
+  n1     = MIN( n, maxgrp - pos );
+
+  drvHy8413_deinterleave( &card_ps->fifo_s.buf_a[pos * HY8413_NUM_CHAN], n1, dst_a, xmask );
+  if ( n1 < n )
+  {
+     for (c=0; c<HY8413_NUM_CHAN; c++)
+        dst2_a[c] = dst_a[c] + n1;
+     drvHy8413_deinterleave( card_ps->fifo_s.buf_a, n - n1, dst2_a, xmask );
+  }
+  epicsMutexUnlock( card_ps->lock );
+  return( n );
+}
+
+/*====================================================
+
+  Abs:  Benchmark the deinterleave
+
+  Name: ip8413DeintBench
+
+  Args: nloop                           Number of passes
+          Type: integer                 Note: default 100
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function deinterleaves a full FIFO (256K words)
+        of test data with the tiled kernel and with the naive
+        per-sample loop, checks that both give the same
+        channel arrays and displays the time and throughput
+        of each, with and without the data format flip.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - Successful, results match
+             ERROR - No memory or results differ
+
+=======================================================*/
+long ip8413DeintBench( int nloop )
+{
+  long              status = OK;
+  int               i;
+  int               k;
+  unsigned long     g;
+  unsigned short    c;
+  unsigned short    xmask;
+  double            dt_a[2];
+  epicsTimeStamp    t0,t1;
+  unsigned short   *src_a  = NULL;
+  char             *mem_p  = NULL;
+  unsigned short   *ref_a[HY8413_NUM_CHAN];
+  unsigned short   *dst_a[HY8413_NUM_CHAN];
+  size_t            bcnt   = HY8413_FIFO_NGRP * sizeof(unsigned short);
+  static const char *name_ac[2] = {"tiled","naive"};
+
+  if ( nloop <= 0 ) nloop = 100;
+
+  /* One block for the source and 32 channel arrays, aligned to 16 bytes */
+  mem_p = calloc( 1, 3*HY8413_FIFO_BCNT*sizeof(unsigned short) + 16 );
+  if ( !mem_p )
+  {
+     errlogPrintf("IP8413: No memory for deinterleave benchmark\n");
+     return( ERROR );
+  }
+  src_a = (unsigned short *)(((unsigned long)mem_p + 15) & ~15UL);
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    dst_a[c] = src_a + HY8413_FIFO_BCNT + c*HY8413_FIFO_NGRP;
+    ref_a[c] = dst_a[c] + HY8413_NUM_CHAN*HY8413_FIFO_NGRP;
+  }
+  for (g=0; g<HY8413_FIFO_BCNT; g++)
+    src_a[g] = (unsigned short)((g * 40503UL) >> 3);
+
+  printf("IP8413 deinterleave of %d sample groups, vector unit: %s, %d passes\n",
+         HY8413_FIFO_NGRP, HY8413_SIMD, nloop );
+  for (k=0; (k<2) && (status==OK); k++)
+  {
+    xmask = k ? HY8413_2C_FLIP : 0;
+    epicsTimeGetCurrent( &t0 );
+    for (i=0; i<nloop; i++)
+      drvHy8413_deinterleave( src_a, HY8413_FIFO_NGRP, dst_a, xmask );
+    epicsTimeGetCurrent( &t1 );
+    dt_a[0] = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+
+    epicsTimeGetCurrent( &t0 );
+    for (i=0; i<nloop; i++)
+      drvHy8413_deinterleave_naive( src_a, HY8413_FIFO_NGRP, ref_a, xmask );
+    epicsTimeGetCurrent( &t1 );
+    dt_a[1] = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+
+    for (c=0; c<HY8413_NUM_CHAN; c++)
+    {
+      if ( memcmp( dst_a[c], ref_a[c], bcnt ) )
+      {
+         printf("\tFAILED: channel %hd differs from reference (xmask=0x%hx)\n",c,xmask);
+         status = ERROR;
+      }
+    }
+    for (i=0; i<2; i++)
+    {
+      printf("\t%s xmask=0x%04hx: %9.3f ms  %8.2f MB/s",
+             name_ac[i], xmask, dt_a[i]*1.0e3,
+             (dt_a[i] > 0.0) ? (double)bcnt*HY8413_NUM_CHAN/dt_a[i]/1.0e6 : 0.0 );
+      if ( i && (dt_a[0] > 0.0) )
+        printf("  (tiled is %.2fx)", dt_a[1]/dt_a[0]);
+      printf("\n");
+    }
+  }
+  free( mem_p );
+  return( status );
+}
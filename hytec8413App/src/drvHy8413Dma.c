@@ -0,0 +1,431 @@
+/*
+=============================================================
+
+  Abs:  Carrier DMA transfer of the external FIFO for a VME
+        Hytec ip-adc-8413 module
+
+  Name: drvHy8413Dma.c
+             drvHy8413_dma_attach     - Attach a carrier DMA engine to a card
+             drvHy8413_dma_rd         - Read words from the external FIFO port
+          *  drvHy8413_dma_local_xfer - Local memcpy stand-in transfer
+             drvHy8413_dma_report     - Display DMA transfer information
+             ip8413DmaLocal           - Attach the local stand-in by name (shell)
+             ip8413DmaTest            - Test the local stand-in (shell)
+
+          * indicates static routines
+
+  Rem:  The module raises DMAREQ0 on the carrier when the
+        external FIFO is full and DMAREQ1 when the internal
+        FIFO is full, if the DRE bit of the CSR is set. How a
+        carrier serves these requests is carrier specific, so
+        the driver only sees a DMA engine (hytec_ipmDma_ts)
+        with a blocking transfer routine, which the carrier
+        support attaches to a card. The drain task then reads
+        the FIFO port with one transfer per contiguous run of
+        the card buffer instead of word by word, leaving the
+        CPU to record processing while the engine waits for
+        the transfer to complete.
+
+        A local engine that copies with memcpy() is provided
+        so the transfer path can be used and tested on a host
+        without carrier DMA.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/* Local Prototypes */
+static long drvHy8413_dma_local_xfer( void                * ctx_p,
+                                      volatile void const * src_p,
+                                      unsigned short        srcInc,
+                                      void                * dst_p,
+                                      unsigned long         nbyte );
+
+/* Local memcpy stand-in for a carrier DMA engine */
+hytec_ipmDma_ts const drvHy8413_dma_local = { "local memcpy",
+                                              drvHy8413_dma_local_xfer,
+                                              NULL,
+                                              0 };
+
+
+/*====================================================
+
+  Abs:  Attach a carrier DMA engine to a card
+
+  Name: drvHy8413_dma_attach
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        dma_ps                          DMA engine
+          Type: pointer                 Note: NULL to use
+          Use:  hytec_ipmDma_ts const *       programmed I/O
+          Acc:  read-only
+          Mech: By reference
+
+  Rem: This function sets the DMA engine used to read the
+       external FIFO of a card. The engine must stay valid
+       while it is attached. The DMA counters are cleared.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, the FIFO is armed
+
+=======================================================*/
+long drvHy8413_dma_attach( void * const                   card_p,
+                           hytec_ipmDma_ts const * const  dma_ps )
+{
+  long           status  = OK;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  epicsMutexMustLock( card_ps->lock );
+  if ( card_ps->fifo_s.state == fifo_armed )
+  {
+     errlogPrintf("IP8413: Unable to change DMA engine while armed - card %s\n",card_ps->name_c);
+     status = ERROR;
+  }
+  else
+  {
+     card_ps->fifo_s.dma_ps  = dma_ps;
+     card_ps->fifo_s.ndma    = 0;
+     card_ps->fifo_s.npio    = 0;
+     card_ps->fifo_s.dmaErr  = 0;
+  }
+  epicsMutexUnlock( card_ps->lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Read words from the external FIFO port
+
+  Name: drvHy8413_dma_rd
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        dst_p                           Destination
+          Type: pointer
+          Use:  unsigned short * const
+          Acc:  write-only
+          Mech: By reference
+
+        nword                           Number of words
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function reads nword words from the external
+       FIFO port into consecutive memory. Runs of at least
+       HY8413_DMA_MIN_WORDS words go through the DMA engine
+       of the card, if one is attached. Shorter runs, and
+       runs the engine refuses, are read by programmed I/O.
+       An engine may only refuse a transfer it has not
+       started, since reading the FIFO is destructive.
+
+  Side: Called by the drain task with the card lock held.
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_dma_rd( void * const           card_p,
+                       unsigned short * const dst_p,
+                       unsigned long          nword )
+{
+  unsigned long           i;
+  IPADC_ID                card_ps = (IPADC_ID)card_p;
+  HY8413_IO               io_ps   = (HY8413_IO)card_ps->io_p;
+  hytec_ipmDma_ts const  *dma_ps  = card_ps->fifo_s.dma_ps;
+
+  if ( dma_ps && (nword >= HY8413_DMA_MIN_WORDS) )
+  {
+     if ( (*dma_ps->xfer_pf)( dma_ps->ctx_p,
+                              &io_ps->fifo_s.external,
+                              0,
+                              dst_p,
+                              nword * sizeof(unsigned short) ) == OK )
+     {
+        card_ps->fifo_s.ndma += nword;
+        return;
+     }
+     card_ps->fifo_s.dmaErr++;
+  }
+  for (i=0; i<nword; i++)
+    dst_p[i] = io_ps->fifo_s.external;
+  card_ps->fifo_s.npio += nword;
+  return;
+}
+
+/*====================================================
+
+  Abs:  Local memcpy stand-in transfer
+
+  Name: drvHy8413_dma_local_xfer
+
+  Args: ctx_p                           Engine context
+          Type: pointer                 Note: not used
+          Use:  void *
+          Acc:  read-only
+          Mech: By reference
+
+        src_p                           Source address
+          Type: pointer
+          Use:  volatile void const *
+          Acc:  read-only
+          Mech: By reference
+
+        srcInc                          Source increments
+          Type: integer                 Note: 0 for a FIFO port
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        dst_p                           Destination address
+          Type: pointer
+          Use:  void *
+          Acc:  write-only
+          Mech: By reference
+
+        nbyte                           Number of bytes
+          Type: integer                 Note: even
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: The transfer routine of the local engine. Memory is
+       copied with memcpy(). A non-incrementing source is a
+       device port, which is read 16 bits at a time.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Odd byte count
+
+=======================================================*/
+static long drvHy8413_dma_local_xfer( void                * ctx_p,
+                                      volatile void const * src_p,
+                                      unsigned short        srcInc,
+                                      void                * dst_p,
+                                      unsigned long         nbyte )
+{
+  unsigned long                    i;
+  unsigned short                  *dst_a = (unsigned short *)dst_p;
+  volatile unsigned short const   *port_p = (volatile unsigned short const *)src_p;
+
+  if ( nbyte & 1 )
+     return( ERROR );
+  if ( srcInc )
+     memcpy( dst_p, (void const *)src_p, nbyte );
+  else
+  {
+     for (i=0; i<nbyte/sizeof(unsigned short); i++)
+       dst_a[i] = *port_p;
+  }
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Display DMA transfer information
+
+  Name: drvHy8413_dma_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        DMA engine of a card and the number of words read
+        by DMA and by programmed I/O.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_dma_report( void const * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->fifo_s.dma_ps ) return;
+
+  printf("\t      dma: %s%s  words dma: %lu  pio: %lu  refused: %lu\n",
+         card_ps->fifo_s.dma_ps->name_c,
+         card_ps->fifo_s.dma_ps->dreq ? " (DMAREQ)" : "",
+         card_ps->fifo_s.ndma,
+         card_ps->fifo_s.npio,
+         card_ps->fifo_s.dmaErr );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Attach the local stand-in by name
+
+  Name: ip8413DmaLocal
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        enable                       Use the local engine
+          Type: integer              Note: 0=programmed I/O
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Shell wrapper for drvHy8413_dma_attach() with the
+        local memcpy engine.
+
+  Side: None
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found or FIFO armed
+
+=======================================================*/
+long ip8413DmaLocal( char const * const name_c, int enable )
+{
+  IPADC_ID  card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  return( drvHy8413_dma_attach( card_ps, enable ? &drvHy8413_dma_local : NULL ) );
+}
+
+/*====================================================
+
+  Abs:  Test the local stand-in
+
+  Name: ip8413DmaTest
+
+  Args: nloop                           Number of passes
+          Type: integer                 Note: default 100
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function transfers a full FIFO (256K words)
+        of test data with the local engine, from memory and
+        from a single port address, checks the result against
+        a word loop and displays the time of each.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - Successful, results match
+             ERROR - No memory or results differ
+
+=======================================================*/
+long ip8413DmaTest( int nloop )
+{
+  long              status = OK;
+  int               i;
+  unsigned long     j;
+  double            dt_a[3];
+  epicsTimeStamp    t0,t1;
+  unsigned short   *src_a  = NULL;
+  unsigned short   *dst_a  = NULL;
+  unsigned long     nbyte  = HY8413_FIFO_BCNT * sizeof(unsigned short);
+  static const char *name_ac[3] = {"memcpy","port","word loop"};
+
+  if ( nloop <= 0 ) nloop = 100;
+
+  src_a = calloc( 2*HY8413_FIFO_BCNT, sizeof(unsigned short) );
+  if ( !src_a )
+  {
+     errlogPrintf("IP8413: No memory for DMA test\n");
+     return( ERROR );
+  }
+  dst_a = src_a + HY8413_FIFO_BCNT;
+  for (j=0; j<HY8413_FIFO_BCNT; j++)
+    src_a[j] = (unsigned short)((j * 40503UL) >> 3);
+
+  printf("IP8413 DMA test with the %s engine, %d words, %d passes\n",
+         drvHy8413_dma_local.name_c, HY8413_FIFO_BCNT, nloop );
+
+  /* Memory to memory */
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; (i<nloop) && (status==OK); i++)
+    status = (*drvHy8413_dma_local.xfer_pf)( NULL, src_a, 1, dst_a, nbyte );
+  epicsTimeGetCurrent( &t1 );
+  dt_a[0] = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+  if ( (status == OK) && memcmp( src_a, dst_a, nbyte ) )
+  {
+     printf("\tFAILED: memory transfer differs from source\n");
+     status = ERROR;
+  }
+
+  /* Single port address, every word is the same */
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; (i<nloop) && (status==OK); i++)
+    status = (*drvHy8413_dma_local.xfer_pf)( NULL, &src_a[1], 0, dst_a, nbyte );
+  epicsTimeGetCurrent( &t1 );
+  dt_a[1] = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+  for (j=0; (j<HY8413_FIFO_BCNT) && (status==OK); j++)
+  {
+    if ( dst_a[j] != src_a[1] )
+    {
+       printf("\tFAILED: port transfer word %lu is 0x%04hx, expected 0x%04hx\n",j,dst_a[j],src_a[1]);
+       status = ERROR;
+    }
+  }
+
+  /* Reference word loop */
+  epicsTimeGetCurrent( &t0 );
+  for (i=0; i<nloop; i++)
+    for (j=0; j<HY8413_FIFO_BCNT; j++)
+      ((volatile unsigned short *)dst_a)[j] = ((volatile unsigned short *)src_a)[j];
+  epicsTimeGetCurrent( &t1 );
+  dt_a[2] = epicsTimeDiffInSeconds( &t1, &t0 )/nloop;
+
+  for (i=0; (i<3) && (status==OK); i++)
+    printf("\t%-9s: %9.3f ms  %8.2f MB/s\n",
+           name_ac[i], dt_a[i]*1.0e3,
+           (dt_a[i] > 0.0) ? (double)nbyte/dt_a[i]/1.0e6 : 0.0 );
+  free( src_a );
+  return( status );
+}
@@ -0,0 +1,369 @@
+/*
+=============================================================
+
+  Abs:  Drift correction for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Drift.c
+          *  drvHy8413_drift_step   - One period of drift correction
+          *  drvHy8413_drift_task   - Drift correction task
+             drvHy8413_drift_report - Display drift correction information
+             ip8413Drift            - Enable or disable drift correction (shell)
+
+          * indicates static routines
+
+  Rem:  The id prom calibration is taken at the factory. The
+        module also converts an on-board 0V and 2.5V reference,
+        read back in the ref_zero_volt and ref_2_5_volt
+        registers. When drift correction is enabled, one low
+        priority task per card reads both references once per
+        HY8413_DRIFT_PERIOD and low-pass filters them with an
+        exponential moving average of weight 2^-shft.
+
+        Once the filters have seen 2^shft readings, their
+        values become the baseline. After that, the gain and
+        offset that map the baseline onto the filtered
+        references,
+
+            raw now = gain * raw then + off
+
+        are applied to the id prom calibration points of the
+        range in use (see drvHy8413_cal_trim()), so the
+        calibration follows the module as it drifts away from
+        the baseline, temperature drift mostly. A gain further
+        than HY8413_DRIFT_MAXGAIN from 1 is taken as a broken
+        reading and skipped. The baseline is taken again after
+        a range or format change.
+
+        A new trim is applied only when it moves a calibration
+        point by HY8413_DRIFT_DEADBAND counts or more from the
+        trim in use, so the filtered references wandering by a
+        count do not rebuild the tables back and forth.
+
+        The task checks that correction is enabled and applies
+        the trim under the calibration lock, and ip8413Drift()
+        disables it and restores the points under the same
+        lock, so a trim computed before correction was
+        disabled is never applied after it.
+
+        The trim is folded into the calibration points, and
+        from there into the tables, fixed-point segments and
+        EGU coefficients, so it costs nothing per sample.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        17-Oct-2026, agent            (AGENT):
+           Check and trim under the calibration lock, add a deadband
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/* Local Prototypes */
+static void drvHy8413_drift_step( IPADC_ID card_ps, unsigned short shft );
+static void drvHy8413_drift_task( void *card_p );
+
+
+/*====================================================
+
+  Abs:  One period of drift correction
+
+  Name: drvHy8413_drift_step
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        shft                            Filter weight
+          Type: integer                 Note: ema weight 2^-shft
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function reads the references, filters them,
+       takes the baseline and, past the deadband, trims the
+       calibration points.
+
+  Side: Called with the calibration lock held.
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_drift_step( IPADC_ID card_ps, unsigned short shft )
+{
+  unsigned short r0;
+  unsigned short r25;
+  double         w;
+  double         gain;
+  double         off;
+  double         span;
+  double         dgain;
+  double         doff;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  /* Start over on a range or format change */
+  if ( (card_ps->drift_s.range  != card_ps->range) ||
+       (card_ps->drift_s.format != card_ps->format) )
+  {
+    if ( card_ps->cal_s.trim ) drvHy8413_cal_trim( card_ps, 1.0, 0.0 );
+    card_ps->drift_s.range  = card_ps->range;
+    card_ps->drift_s.format = card_ps->format;
+    card_ps->drift_s.n      = 0;
+  }
+
+  /* References, as offset binary */
+  r0  = io_ps->ref_zero_volt;
+  r25 = io_ps->ref_2_5_volt;
+  if ( card_ps->format == twos_compliment )
+  {
+    r0  ^= 0x8000;
+    r25 ^= 0x8000;
+  }
+  if ( !card_ps->drift_s.n )
+  {
+    card_ps->drift_s.r0  = r0;
+    card_ps->drift_s.r25 = r25;
+  }
+  else
+  {
+    w = 1.0/(double)(1UL << shft);
+    card_ps->drift_s.r0  += w * ((double)r0  - card_ps->drift_s.r0);
+    card_ps->drift_s.r25 += w * ((double)r25 - card_ps->drift_s.r25);
+  }
+  card_ps->drift_s.n++;
+  if ( card_ps->drift_s.n < (1UL << shft) ) return;
+  if ( card_ps->drift_s.n == (1UL << shft) )
+  {
+    card_ps->drift_s.b0  = card_ps->drift_s.r0;
+    card_ps->drift_s.b25 = card_ps->drift_s.r25;
+    return;
+  }
+
+  span = card_ps->drift_s.b25 - card_ps->drift_s.b0;
+  if ( fabs(span) < HY8413_DRIFT_MINSPAN )
+  {
+    card_ps->drift_s.nskip++;
+    return;
+  }
+  gain = (card_ps->drift_s.r25 - card_ps->drift_s.r0)/span;
+  if ( fabs(gain - 1.0) > HY8413_DRIFT_MAXGAIN )
+  {
+    card_ps->drift_s.nskip++;
+    return;
+  }
+  off = card_ps->drift_s.r0 - gain * card_ps->drift_s.b0;
+  card_ps->drift_s.gain = gain;
+  card_ps->drift_s.off  = off;
+
+  /*
+   * Deadband: the move of a point is linear in the point,
+   * so the largest is at one end of the 16 bit range. With
+   * no trim in use the points are the id prom points.
+   */
+  dgain = gain - 1.0;
+  doff  = off;
+  if ( card_ps->cal_s.trim )
+  {
+    dgain -= card_ps->cal_s.trimGain - 1.0;
+    doff  -= card_ps->cal_s.trimOff;
+  }
+  if ( (fabs(doff) < HY8413_DRIFT_DEADBAND) &&
+       (fabs(dgain * (double)OFFSET_BINARY_MAX + doff) < HY8413_DRIFT_DEADBAND) )
+  {
+    card_ps->drift_s.nhold++;
+    return;
+  }
+  drvHy8413_cal_trim( card_ps, gain, off );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Drift correction task
+
+  Name: drvHy8413_drift_task
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This task runs one period of drift correction once
+       per HY8413_DRIFT_PERIOD, under the calibration lock,
+       and idles while drift correction is disabled.
+
+  Side: Runs until the ioc is rebooted.
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_drift_task( void *card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  while (1)
+  {
+    epicsThreadSleep( HY8413_DRIFT_PERIOD );
+    epicsMutexMustLock( card_ps->cal_s.lock );
+    if ( card_ps->drift_s.shft )
+      drvHy8413_drift_step( card_ps, card_ps->drift_s.shft );
+    epicsMutexUnlock( card_ps->cal_s.lock );
+  }
+}
+
+/*====================================================
+
+  Abs:  Display drift correction information
+
+  Name: drvHy8413_drift_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        filtered references, the baseline and the last trim
+        of a card with drift correction enabled.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_drift_report( void const * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->drift_s.tid ) return;
+
+  if ( !card_ps->drift_s.shft )
+  {
+    printf("\tDrift correction: Disabled\n");
+    return;
+  }
+  printf("\tDrift correction: ema 2^-%hu  readings: %lu  refs: %.2f %.2f  baseline: %.2f %.2f\n",
+         card_ps->drift_s.shft,
+         card_ps->drift_s.n,
+         card_ps->drift_s.r0,
+         card_ps->drift_s.r25,
+         card_ps->drift_s.b0,
+         card_ps->drift_s.b25 );
+  printf("\tDrift trim: gain: %.6f  offset: %.2f counts  skipped: %lu  in deadband: %lu\n",
+         card_ps->drift_s.gain,
+         card_ps->drift_s.off,
+         card_ps->drift_s.nskip,
+         card_ps->drift_s.nhold );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Enable or disable drift correction (shell)
+
+  Name: ip8413Drift
+
+  Args: name_c                          Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        shft                            Filter weight
+          Type: integer                 Note: 0=off, or ema weight
+          Use:  int                           2^-shft, 1 to
+          Acc:  read-only                     HY8413_DRIFT_MAXSHFT
+          Mech: By value
+
+  Rem:  With shft set, the drift task of the card is started,
+        if not already running, and the references are filtered
+        over about 2^shft periods. The baseline is taken after
+        2^shft readings, so with the 1 second period a weight
+        of 2^-6 starts trimming after about a minute. With shft
+        0 the task idles and the id prom calibration points are
+        restored. Enabling again restores them too and takes a
+        new baseline. Both are done under the calibration
+        lock, so the task does not apply a trim afterwards.
+        For example:
+
+            ip8413Drift("ADC0",6)
+
+  Side: The calibration lock is taken.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Card not found, no calibration data or
+                     invalid weight
+
+=======================================================*/
+long ip8413Drift( char const * const name_c, int shft )
+{
+  long      status;
+  IPADC_ID  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( card_ps->cal_s.type == nocal )
+  {
+     errlogPrintf("IP8413: No calibration data to trim on card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( (shft < 0) || (shft > HY8413_DRIFT_MAXSHFT) )
+  {
+     errlogPrintf("IP8413: Invalid drift filter weight 2^-%d\n",shft);
+     return( ERROR );
+  }
+
+  epicsMutexMustLock( card_ps->cal_s.lock );
+  if ( !shft )
+  {
+     card_ps->drift_s.shft = 0;
+     status = drvHy8413_cal_trim( card_ps, 1.0, 0.0 );
+     epicsMutexUnlock( card_ps->cal_s.lock );
+     return( status );
+  }
+
+  if ( card_ps->cal_s.trim ) drvHy8413_cal_trim( card_ps, 1.0, 0.0 );
+  card_ps->drift_s.range  = card_ps->range;
+  card_ps->drift_s.format = card_ps->format;
+  card_ps->drift_s.n      = 0;
+  card_ps->drift_s.nskip  = 0;
+  card_ps->drift_s.nhold  = 0;
+  card_ps->drift_s.shft   = shft;
+  epicsMutexUnlock( card_ps->cal_s.lock );
+  if ( !card_ps->drift_s.tid )
+    card_ps->drift_s.tid = epicsThreadMustCreate( HY8413_DRIFT_NAME,
+                                                  HY8413_DRIFT_PRI,
+                                                  HY8413_DRIFT_STACK,
+                                                  drvHy8413_drift_task,
+                                                  card_ps );
+  return( OK );
+}
@@ -0,0 +1,2018 @@
+/*
+=============================================================
+
+  Abs:  External FIFO Driver Support for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Fifo.c
+             drvHy8413_fifo_init     - Allocate buffer, start drain task and connect isr
+             drvHy8413_fifo_stop     - Disable the interrupts and stop the drain task
+             drvHy8413_isr           - Interrupt service routine
+          *  drvHy8413_fifo_task     - Drain task, waits for the isr
+             drvHy8413_fifo_ngrp     - Number of sample groups available in the FIFO
+          *  drvHy8413_fifo_pre      - Read the pre-trigger FIFO into the card buffer
+          *  drvHy8413_fifo_stamp    - Stamp sample groups with sequence numbers
+          *  drvHy8413_fifo_gap      - Account for sample groups lost to overflow
+             drvHy8413_fifo_drain    - Read available sample groups into the card buffer
+             drvHy8413_fifo_oldest   - Ring position of the most recent groups
+             drvHy8413_fifo_rd_chan  - Copy the captured samples of one channel
+             drvHy8413_fifo_rd_seq   - Copy the sequence numbers of the captured samples
+          *  drvHy8413_fifo_start    - Reset the FIFO and arm in the requested mode
+             drvHy8413_fifo_arm      - Reset the FIFO and arm for a triggered capture
+             drvHy8413_fifo_arm_pre  - Arm for a capture including pre-trigger samples
+             drvHy8413_fifo_item     - Read an external FIFO status item
+             drvHy8413_fifo_stream   - Reset the FIFO and arm for a streaming readout
+          *  drvHy8413_fifo_grow     - Enlarge the card buffer
+             drvHy8413_fifo_segment  - Reset the FIFO and arm for a segmented capture
+             drvHy8413_fifo_seg      - Trigger information of a capture segment
+             drvHy8413_fifo_soft     - Arm and software trigger a short capture
+             drvHy8413_fifo_snap     - Software triggered capture, wait for completion
+             drvHy8413_clk_hz        - Sample clock rate in Hz
+             drvHy8413_fifo_report   - Display FIFO readout information
+             ip8413FifoArm           - Arm the FIFO of a card by name (shell)
+             ip8413FifoArmPre        - Arm the FIFO with pre-trigger samples (shell)
+             ip8413FifoStream        - Start streaming the FIFO of a card by name (shell)
+             ip8413FifoSegment       - Arm a segmented capture of a card by name (shell)
+             ip8413FifoSegShow       - Display the segments of a card by name (shell)
+             ip8413FifoSnap          - Software triggered capture of a card by name (shell)
+
+          * indicates static routines
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "epicsInterrupt.h"
+#include "errlog.h"
+#include "cantProceed.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/* Local Prototypes */
+static void drvHy8413_fifo_task( void * card_p );
+static long drvHy8413_fifo_start( IPADC_ID       card_ps,
+                                  unsigned short mode,
+                                  unsigned long  nreq );
+static void drvHy8413_fifo_pre( IPADC_ID card_ps );
+static void drvHy8413_fifo_stamp( IPADC_ID card_ps, unsigned long pos, unsigned long n );
+static unsigned long drvHy8413_fifo_gap( IPADC_ID       card_ps,
+                                         unsigned long  n,
+                                         unsigned short csr );
+static long drvHy8413_fifo_grow( IPADC_ID card_ps, unsigned long ngrp );
+
+/* Global variables */
+extern int debugHy8413;
+
+/*
+ * The fullness counter is 16-bits and rolls over every quarter
+ * of the FIFO, which is flagged by the QF and THF status bits.
+ */
+#define HY8413_FIFO_QTR   (HY8413_FIFO_BCNT/4)
+
+/* 
+ * The count is only a lower bound past the half full mark, so the
+ * FIFO is drained until empty, at most once per quarter and the full.
+ */
+#define HY8413_FIFO_NPASS 5
+
+/* Sample clock rate in Hz for each clock rate register setting */
+static const double clk_hz_a[HY8413_MAX_CLK_RATE] = {     1.0,     2.0,     5.0,    10.0,
+                                                         20.0,    50.0,   100.0,   200.0,
+                                                        500.0,  1000.0,  2000.0,  5000.0,
+                                                      10000.0, 20000.0, 50000.0,100000.0 };
+
+
+/*====================================================
+
+  Abs:  Setup interrupt driven external FIFO readout
+
+  Name: drvHy8413_fifo_init
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        mask                            Module setup bitmask
+          Type: bitmask                 Note: see HY8413_MASK_xxx
+          Use:  unsigned long                 in drvHy8413.h
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function allocates the per-card buffer that holds
+       the drained FIFO data, starts the drain task and
+       connects the interrupt service routine on the vector
+       and level of this card. The FIFO interrupts are not
+       enabled until the FIFO is armed (see drvHy8413_fifo_arm).
+
+  Side: Called from drvHy8413_init() prior to iocInit().
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, no vector or failed to connect
+
+=======================================================*/
+long drvHy8413_fifo_init( void * const card_p, unsigned long mask )
+{
+  long           status  = OK;
+  int            level   = 0;
+  int            param;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+
+  if ( !card_ps->intVec )
+  {
+     errlogPrintf("IP8413: No interrupt vector specified for card %s\n",card_ps->name_c);
+     return( ERROR );
+  }
+  param = hytec_ipmIsrParam( card_ps );
+  if ( param < 0 )
+  {
+     errlogPrintf("IP8413: Too many cards with interrupts, card %s not connected\n",card_ps->name_c);
+     return( ERROR );
+  }
+
+  /* Interrupt level, as requested or the default */
+  level = (mask & HY8413_MASK_LVL) >> HY8413_MASK_LVL_SHFT;
+  if ( (level <= MIN_INT_LEVEL) || (level > MAX_INT_LEVEL) )
+     level = DEFAULT_INT_LEVEL;
+  card_ps->intLevel = level;
+
+  /* Buffer for one full FIFO of sample groups and the pre-trigger FIFO */
+  card_ps->fifo_s.maxgrp  = HY8413_FIFO_NGRP + HY8413_PRE_NGRP;
+  card_ps->fifo_s.buf_a   = callocMustSucceed( card_ps->fifo_s.maxgrp * HY8413_NUM_CHAN,
+                                               sizeof(unsigned short),
+                                               "drvHy8413_fifo_init()" );
+  card_ps->fifo_s.seq_a   = callocMustSucceed( card_ps->fifo_s.maxgrp,
+                                               sizeof(unsigned long long),
+                                               "drvHy8413_fifo_init()" );
+  card_ps->fifo_s.ngrp    = 0;
+  card_ps->fifo_s.wpos    = 0;
+  card_ps->fifo_s.nbuf    = 0;
+  card_ps->fifo_s.state   = fifo_idle;
+  card_ps->fifo_s.intMask = HY8413_CSR_INT_MASK;
+  drvHy8413_wf_init( card_ps );
+  card_ps->fifo_s.nsoft   = HY8413_SOFT_NGRP;
+  card_ps->fifo_s.evt     = epicsEventMustCreate( epicsEventEmpty );
+  card_ps->fifo_s.done    = epicsEventMustCreate( epicsEventEmpty );
+  card_ps->fifo_s.exit    = epicsEventMustCreate( epicsEventEmpty );
+  card_ps->fifo_s.tid     = epicsThreadMustCreate( HY8413_DONE_NAME,
+                                                   HY8413_DONE_PRI,
+                                                   HY8413_DONE_STACK,
+                                                   drvHy8413_fifo_task,
+                                                   card_ps );
+
+  /* Make sure the FIFO interrupts are disabled before connecting */
+  io_ps->csr &= ~HY8413_CSR_INT_MASK;
+  io_ps->vec  = card_ps->intVec;
+  card_ps->rtn_s.isr_pf = (VOIDFUNPTR)drvHy8413_isr;
+
+  if ( ipmIntConnect( card_ps->carrier,
+                      card_ps->slot,
+                      card_ps->intVec,
+                      hytec_ipmIsr,
+                      param ) )
+  {
+     errlogPrintf("IP8413: Failed to connect interrupt vector 0x%x - card: %hd  slot: %hd\n",
+                  card_ps->intVec,
+                  card_ps->carrier,
+                  card_ps->slot );
+     status = ERROR;
+  }
+  else
+  {
+     ipmIrqCmd( card_ps->carrier, card_ps->slot, 0, (ipac_irqCmd_t)level );
+     ipmIrqCmd( card_ps->carrier, card_ps->slot, 0, ipac_irqEnable );
+     card_ps->intHandler = 1;
+  }
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Disable the interrupts and stop the drain task
+
+  Name: drvHy8413_fifo_stop
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function undoes drvHy8413_fifo_init() when the
+       card fails to initialize. The FIFO interrupts are
+       disabled in the CSR and at the carrier, the service
+       routine is withdrawn and the drain task is asked to
+       exit and waited for. The buffers are released.
+
+       drvIpac has no way to disconnect the vector, so the
+       card information must not be freed once the isr has
+       been connected (card_ps->intHandler set).
+
+  Side: Called from drvHy8413_init() prior to iocInit().
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_fifo_stop( void * const card_p )
+{
+  int            key;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  key = epicsInterruptLock();
+  io_ps->csr &= ~(HY8413_CSR_INT_MASK | HY8413_CSR_ET | HY8413_CSR_DRE);
+  card_ps->rtn_s.isr_pf = NULL;
+  epicsInterruptUnlock( key );
+  if ( card_ps->intHandler )
+     ipmIrqCmd( card_ps->carrier, card_ps->slot, 0, ipac_irqDisable );
+
+  if ( card_ps->fifo_s.tid )
+  {
+     card_ps->fifo_s.quit = 1;
+     epicsEventSignal( card_ps->fifo_s.evt );
+     epicsEventMustWait( card_ps->fifo_s.exit );
+     card_ps->fifo_s.tid = NULL;
+  }
+  card_ps->fifo_s.state = fifo_idle;
+  if ( card_ps->fifo_s.buf_a ) free( card_ps->fifo_s.buf_a );
+  if ( card_ps->fifo_s.seq_a ) free( card_ps->fifo_s.seq_a );
+  card_ps->fifo_s.buf_a  = NULL;
+  card_ps->fifo_s.seq_a  = NULL;
+  card_ps->fifo_s.maxgrp = 0;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Interrupt service routine
+
+  Name: drvHy8413_isr
+
+  Args: card_p                       Card configuration
+          Type: pointer
+          Use:  void *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem:  The FIFO half full and full conditions remain
+        asserted until the FIFO is read, so the interrupt
+        enables are cleared here and restored by the
+        drain task once the data has been read out.
+
+  Side: Called at interrupt level from hytec_ipmIsr()
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_isr( void * card_p )
+{
+  IPADC_ID   card_ps = (IPADC_ID)card_p;
+  HY8413_IO  io_ps   = (HY8413_IO)card_ps->io_p;
+
+  card_ps->fifo_s.csr = io_ps->csr;
+  io_ps->csr &= ~HY8413_CSR_INT_MASK;
+  card_ps->fifo_s.nint++;
+  epicsEventSignal( card_ps->fifo_s.evt );
+  return;
+}
+
+/*====================================================
+
+  Abs:  External FIFO drain task
+
+  Name: drvHy8413_fifo_task
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem:  This task waits for the interrupt service routine
+        and then empties the external FIFO into the card
+        buffer. Once the requested number of sample groups
+        has been read the trigger is disabled and the capture
+        is flagged done. Otherwise, the FIFO interrupts are
+        enabled again. When streaming, the task also wakes
+        up at the poll period so that the FIFO is read while
+        it is filling, well before it is half full.
+
+        Since the number of groups in the FIFO is a lower bound
+        (see drvHy8413_fifo_ngrp), the FIFO is drained again
+        until it reports no more groups, for at most
+        HY8413_FIFO_NPASS passes.
+
+        In segmented mode, once a segment is complete the rest
+        of the FIFO is discarded and the trigger is enabled
+        again for the next segment.
+
+        Waveform records are scanned when a capture is done,
+        or after each drain of a continuous stream. A completed
+        capture is first published to the waveform buffer pool.
+
+  Side: Exits when asked by drvHy8413_fifo_stop().
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_fifo_task( void * card_p )
+{
+  int              key;
+  int              seg;
+  int              tmo;
+  int              done;
+  int              pass;
+  unsigned long    n;
+  unsigned long    m;
+  hytec_ipmSeg_ts *seg_ps;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  for (;;)
+  {
+     tmo = 0;
+     if ( (card_ps->fifo_s.state == fifo_armed) && 
+          ((card_ps->fifo_s.mode == acq_stream) || (card_ps->fifo_s.mode == acq_segment) ||
+           (card_ps->fifo_s.mode == acq_soft)) )
+        tmo = (epicsEventWaitWithTimeout( card_ps->fifo_s.evt, card_ps->fifo_s.poll ) == epicsEventWaitTimeout);
+     else
+        epicsEventMustWait( card_ps->fifo_s.evt );
+     if ( card_ps->fifo_s.quit )
+     {
+        epicsEventSignal( card_ps->fifo_s.exit );
+        return;
+     }
+     epicsMutexMustLock( card_ps->lock );
+     if ( card_ps->fifo_s.state == fifo_armed )
+     {
+        n = 0;
+        for (pass=0; pass<HY8413_FIFO_NPASS; pass++)
+        {
+          m  = drvHy8413_fifo_drain( card_ps );
+          n += m;
+          if ( !m ) break;
+        }
+        if ( debugHy8413 )
+          printf("drvHy8413(fifo): %s csr=0x%hx drained %lu groups (%lu total)\n",
+                 card_ps->name_c,
+                 card_ps->fifo_s.csr,
+                 n,
+                 card_ps->fifo_s.ngrp );
+
+        /* A running stream should have data at every poll */
+        if ( tmo && !n && card_ps->fifo_s.trig && (card_ps->fifo_s.mode == acq_stream) )
+        {
+           card_ps->err_cnt_s.tmo++;
+           card_ps->err_cnt_s.cnt++;
+        }
+
+        /* End of a segment? */
+        seg = 0;
+        if ( (card_ps->fifo_s.mode == acq_segment) && card_ps->fifo_s.trig &&
+             (card_ps->fifo_s.ngrp >= (card_ps->fifo_s.iseg+1) * card_ps->fifo_s.seglen) )
+        {
+           seg_ps = &card_ps->fifo_s.seg_as[card_ps->fifo_s.iseg++];
+           seg_ps->trigIdx      = card_ps->fifo_s.trigIdx;
+           seg_ps->time         = card_ps->fifo_s.trigTime;
+           card_ps->fifo_s.trig = 0;
+           seg = 1;
+        }
+
+        key = epicsInterruptLock();
+        if ( seg )
+        {
+           /* Discard the rest of the FIFO and wait for the next trigger */
+           io_ps->csr &= ~HY8413_CSR_ET;
+           io_ps->csr |= HY8413_CSR_RST;
+           io_ps->csr &= ~HY8413_CSR_RST;
+           if ( card_ps->fifo_s.iseg < card_ps->fifo_s.nseg )
+              io_ps->csr |= HY8413_CSR_ET;
+        }
+        if ( card_ps->fifo_s.nreq && (card_ps->fifo_s.ngrp >= card_ps->fifo_s.nreq) )
+        {
+           /* Capture complete, stop routing samples to the FIFO */
+           io_ps->csr &= ~(HY8413_CSR_ET | HY8413_CSR_DRE);
+           card_ps->fifo_s.state = fifo_done;
+        }
+        else if ( io_ps->csr & HY8413_CSR_THF )
+        {
+           /* Still half full, wait for the full interrupt only */
+           io_ps->csr |= (card_ps->fifo_s.intMask & HY8413_CSR_ETF);
+        }
+        else
+           io_ps->csr |= card_ps->fifo_s.intMask;
+        epicsInterruptUnlock( key );
+
+        done = (card_ps->fifo_s.state == fifo_done);
+        if ( seg || done )
+           drvHy8413_snap_reg_touch( card_ps );
+        if ( done )
+           drvHy8413_wf_publish( card_ps );
+        if ( done || (n && !card_ps->fifo_s.nreq) )
+        {
+           epicsTimeGetCurrent( &card_ps->fifo_s.time );
+           n = 1;
+        }
+        else
+           n = 0;
+     }
+     else
+        n = done = 0;
+     epicsMutexUnlock( card_ps->lock );
+
+     /* New data for the waveform records */
+     if ( n )
+        scanIoRequest( card_ps->fifo_s.wfScan );
+     if ( done )
+        epicsEventSignal( card_ps->fifo_s.done );
+  }/* End of FOR loop */
+}
+
+/*====================================================
+
+  Abs:  Number of sample groups available in the external FIFO
+
+  Name: drvHy8413_fifo_ngrp
+
+  Args: io_p                            Base io address Card
+          Type: pointer
+          Use:  volatile unsigned short * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem: This function returns a lower bound of the number of
+       complete 16-channel sample groups in the external FIFO.
+       The fullness counter is 16-bits, so the post-trigger
+       quarter full (QF) and half full (THF) status is added
+       to the count. The status is read before the counter so
+       that a roll over between the two reads is underestimated.
+       Past the half full mark the counter may also have rolled
+       over a third time, which the status can not tell, so
+       callers read until the FIFO is empty rather than rely on
+       a single count (see drvHy8413_fifo_task).
+
+  Side: None
+
+  Ret:  unsigned long
+             Number of sample groups (0 - HY8413_FIFO_NGRP)
+
+=======================================================*/
+unsigned long drvHy8413_fifo_ngrp( volatile unsigned short * const io_p )
+{
+  unsigned short csr;
+  unsigned long  nwords;
+  HY8413_IO      io_ps = (HY8413_IO)io_p;
+
+  csr = io_ps->csr;
+  if ( csr & HY8413_CSR_TF )
+     return( HY8413_FIFO_NGRP );
+
+  nwords = io_ps->fifo_s.full;
+  if ( csr & HY8413_CSR_THF )
+     nwords += 2*HY8413_FIFO_QTR;
+  else if ( csr & HY8413_CSR_QF )
+     nwords += HY8413_FIFO_QTR;
+  return( nwords/HY8413_NUM_CHAN );
+}
+
+/*====================================================
+
+  Abs:  Read the pre-trigger FIFO into the card buffer
+
+  Name: drvHy8413_fifo_pre
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function empties the pre-trigger (internal) FIFO,
+       which holds the conversions sampled just before the
+       trigger, into the start of the card buffer. Only whole
+       sample groups are kept. Since the newest conversion is
+       read last, a partial group can only be at the start
+       and is dropped. The request is extended by the number of
+       groups read, so the post-trigger data follows on
+       directly and the trigger is at sample npre of the capture.
+
+  Side: The caller must hold the card lock. Called once per
+        capture, before any post-trigger data is read.
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_fifo_pre( IPADC_ID card_ps )
+{
+  unsigned long   n   = 0;
+  unsigned long   r   = 0;
+  unsigned short *dst_a = card_ps->fifo_s.buf_a;
+  HY8413_IO       io_ps = (HY8413_IO)card_ps->io_p;
+
+  while ( !(io_ps->csr & HY8413_CSR_FE) && (n < HY8413_PRE_BCNT) )
+    dst_a[n++] = io_ps->fifo_s.internal;
+
+  r = n % HY8413_NUM_CHAN;
+  if ( r )
+    memmove( dst_a, dst_a + r, (n - r) * sizeof(unsigned short) );
+
+  card_ps->fifo_s.pre   = 0;
+  card_ps->fifo_s.npre  = n / HY8413_NUM_CHAN;
+  card_ps->fifo_s.ngrp += card_ps->fifo_s.npre;
+  card_ps->fifo_s.wpos  = card_ps->fifo_s.npre;
+  card_ps->fifo_s.nbuf  = card_ps->fifo_s.npre;
+  if ( card_ps->fifo_s.nreq )
+    card_ps->fifo_s.nreq += card_ps->fifo_s.npre;
+  return;
+}
+
+/*====================================================
+
+  Abs:  Stamp sample groups with sequence numbers
+
+  Name: drvHy8413_fifo_stamp
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        pos                             First group in the ring
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        n                               Number of groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function gives consecutive sequence numbers to
+       n sample groups of the card buffer (a ring), starting
+       at ring position pos, and advances the next sequence
+       number.
+
+  Side: The caller must hold the card lock.
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_fifo_stamp( IPADC_ID      card_ps,
+                                  unsigned long pos,
+                                  unsigned long n )
+{
+  unsigned long   i;
+
+  for (i=0; i<n; i++,pos++)
+  {
+    if ( pos == card_ps->fifo_s.maxgrp )
+       pos = 0;
+    card_ps->fifo_s.seq_a[pos] = card_ps->fifo_s.seq++;
+  }
+  return;
+}
+
+/*====================================================
+
+  Abs:  Account for sample groups lost to overflow
+
+  Name: drvHy8413_fifo_gap
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        n                               Groups in the FIFO
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        csr                             Control status register
+          Type: bitmask                 Note: read before n
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function detects loss from the FIFO full (TF)
+       status. Groups can only be lost while the FIFO is
+       full, so nothing is counted otherwise. A full FIFO is
+       counted as an overflow (old_data), and the groups lost
+       are estimated from the time since the last drain: the
+       groups the sample clock produced in that time, less
+       those that entered the FIFO (n less the groups left
+       at the last drain). Any difference is counted as a
+       sequence gap (inv_data).
+
+       The estimate relies on the internal clock rate and
+       on the drain timestamps, so it is within a few groups.
+       With an external clock the rate register does not
+       apply and only the overflow is meaningful.
+
+       The sample count register (nsamples) is not used
+       here, it only provides the trigger sample number
+       (see drvHy8413_fifo_drain).
+
+  Side: The caller must hold the card lock.
+
+  Ret:  unsigned long
+             Number of groups lost since the last drain
+
+=======================================================*/
+static unsigned long drvHy8413_fifo_gap( IPADC_ID       card_ps,
+                                         unsigned long  n,
+                                         unsigned short csr )
+{
+  epicsTimeStamp  now;
+  double          dt;
+  double          expect;
+  unsigned long   stored;
+  unsigned long   gap = 0;
+
+  epicsTimeGetCurrent( &now );
+  dt = epicsTimeDiffInSeconds( &now, &card_ps->fifo_s.last );
+  card_ps->fifo_s.last = now;
+  if ( !(csr & HY8413_CSR_TF) )
+     return( 0 );
+
+  card_ps->err_cnt_s.old_data++;
+  card_ps->err_cnt_s.cnt++;
+  stored = (n > card_ps->fifo_s.left) ? n - card_ps->fifo_s.left : 0;
+  expect = dt * drvHy8413_clk_hz( card_ps->io_p ) + 0.5;
+  if ( expect > (double)stored + 1.0 )
+  {
+     gap = (unsigned long)(expect - (double)stored);
+     card_ps->fifo_s.lost += gap;
+     card_ps->err_cnt_s.inv_data++;
+     card_ps->err_cnt_s.cnt++;
+     if ( debugHy8413 )
+        printf("drvHy8413(fifo): %s lost about %lu groups at sequence %llu\n",
+               card_ps->name_c,
+               gap,
+               card_ps->fifo_s.seq + n );
+  }
+  return( gap );
+}
+
+/*====================================================
+
+  Abs:  Drain the external FIFO into the card buffer
+
+  Name: drvHy8413_fifo_drain
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function reads all complete sample groups
+       currently in the external FIFO, up to the number of
+       groups left in the request, or in the current segment.
+       The trigger sample number and time are latched, and the
+       pre-trigger FIFO read, at the first drain that finds
+       post-trigger data. The trigger time is estimated from
+       the number of groups already in the FIFO. The card
+       buffer is used as a ring, so that a continuous stream
+       keeps the most recent groups. The data is always read
+       in groups of 16 words to keep the sample format intact,
+       through the carrier DMA engine if one is attached
+       (see drvHy8413_dma_rd), and copied to the sample ring
+       of the card, if any. Each group read is stamped with
+       its 64-bit sequence number, counted from the trigger,
+       and groups lost to a FIFO overflow are skipped in the
+       sequence (see drvHy8413_fifo_gap). The lost groups are
+       placed after those in the FIFO, which are all read
+       unless the request or segment ends first, in which case
+       the rest of the FIFO is discarded anyway.
+
+       The sample count register (nsamples) is read only when
+       the trigger is latched, as the trigger sample number.
+
+  Side: The caller must hold the card lock.
+
+  Ret:  unsigned long
+             Number of sample groups read
+
+=======================================================*/
+unsigned long drvHy8413_fifo_drain( void * const card_p )
+{
+  unsigned long   n;
+  unsigned long   n1;
+  unsigned long   nfifo;
+  unsigned long   pos;
+  unsigned long   gap = 0;
+  unsigned short  csr;
+  IPADC_ID        card_ps = (IPADC_ID)card_p;
+  HY8413_IO       io_ps   = (HY8413_IO)card_ps->io_p;
+
+  /* The status is read first, so a full FIFO is seen full */
+  csr   = io_ps->csr;
+  n     = drvHy8413_fifo_ngrp( card_ps->io_p );
+  nfifo = n;
+  if ( n > card_ps->fifo_s.peak )
+     card_ps->fifo_s.peak = n;
+
+  /* 
+   * Data in the post-trigger FIFO means the trigger has occurred.
+   * Latch the trigger sample number and, if requested, put the
+   * samples just before the trigger at the start of the buffer.
+   */
+  if ( n && !card_ps->fifo_s.trig )
+  {
+     card_ps->fifo_s.trig    = 1;
+     card_ps->fifo_s.trigIdx = ((unsigned long)io_ps->nsamples_a[1] << 16) | io_ps->nsamples_a[0];
+     epicsTimeGetCurrent( &card_ps->fifo_s.trigTime );
+     epicsTimeAddSeconds( &card_ps->fifo_s.trigTime, -(double)n/drvHy8413_clk_hz( card_ps->io_p ) );
+     if ( card_ps->fifo_s.pre )
+     {
+        drvHy8413_fifo_pre( card_ps );
+        drvHy8413_fifo_stamp( card_ps, 0, card_ps->fifo_s.npre );
+        drvHy8413_ring_write( card_ps, card_ps->fifo_s.buf_a, card_ps->fifo_s.npre );
+     }
+     /* Everything since the estimated trigger time is in the FIFO or lost */
+     card_ps->fifo_s.last = card_ps->fifo_s.trigTime;
+     card_ps->fifo_s.left = 0;
+  }
+  if ( card_ps->fifo_s.trig )
+     gap = drvHy8413_fifo_gap( card_ps, n, csr );
+  if ( card_ps->fifo_s.nreq )
+     n = MIN( n, card_ps->fifo_s.nreq - card_ps->fifo_s.ngrp );
+  if ( card_ps->fifo_s.mode == acq_segment )
+     n = MIN( n, (card_ps->fifo_s.iseg+1) * card_ps->fifo_s.seglen - card_ps->fifo_s.ngrp );
+
+  /* One transfer up to the end of the ring, and one from its start */
+  pos = card_ps->fifo_s.wpos;
+  n1  = MIN( n, card_ps->fifo_s.maxgrp - pos );
+  drvHy8413_dma_rd( card_ps, &card_ps->fifo_s.buf_a[pos * HY8413_NUM_CHAN], n1 * HY8413_NUM_CHAN );
+  drvHy8413_ring_write( card_ps, &card_ps->fifo_s.buf_a[pos * HY8413_NUM_CHAN], n1 );
+  if ( n1 < n )
+  {
+     drvHy8413_dma_rd( card_ps, card_ps->fifo_s.buf_a, (n - n1) * HY8413_NUM_CHAN );
+     drvHy8413_ring_write( card_ps, card_ps->fifo_s.buf_a, n - n1 );
+  }
+  drvHy8413_fifo_stamp( card_ps, pos, n );
+  card_ps->fifo_s.ngrp += n;
+
+  /* The write position wraps on its own, ngrp may wrap anywhere */
+  card_ps->fifo_s.wpos  = (n1 < n) ? n - n1 : pos + n1;
+  if ( card_ps->fifo_s.wpos == card_ps->fifo_s.maxgrp )
+     card_ps->fifo_s.wpos = 0;
+  card_ps->fifo_s.nbuf  = MIN( card_ps->fifo_s.nbuf + n, card_ps->fifo_s.maxgrp );
+
+  /* The groups lost to an overflow follow those in the FIFO */
+  card_ps->fifo_s.seq += gap;
+  card_ps->fifo_s.left = nfifo - n;
+  return( n );
+}
+
+/*====================================================
+
+  Abs:  Ring position of the most recent sample groups
+
+  Name: drvHy8413_fifo_oldest
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-only
+          Mech: By reference
+
+        n                               Number of groups
+          Type: integer                 Note: at most fifo_s.nbuf
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function returns the ring position of the oldest
+       of the n most recent sample groups. It counts back from
+       the write position, which wraps at the ring capacity,
+       rather than from the group count, which does not.
+
+  Side: The caller must hold the card lock.
+
+  Ret:  unsigned long
+             Ring position in groups
+
+=======================================================*/
+unsigned long drvHy8413_fifo_oldest( void * const  card_p,
+                                     unsigned long n )
+{
+  IPADC_ID  card_ps = (IPADC_ID)card_p;
+
+  if ( card_ps->fifo_s.wpos >= n )
+     return( card_ps->fifo_s.wpos - n );
+  return( card_ps->fifo_s.wpos + card_ps->fifo_s.maxgrp - n );
+}
+
+/*====================================================
+
+  Abs:  Copy the captured samples of one channel
+
+  Name: drvHy8413_fifo_rd_chan
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer                 Note: 0-15
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        dst_a                           Sample array
+          Type: array
+          Use:  unsigned short * const
+          Acc:  write-only
+          Mech: By reference
+
+        nelm                            Size of sample array
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function deinterleaves the raw samples of the
+       specified channel from the 16-word sample groups in
+       the card buffer. When more groups were captured than
+       fit in the array, the most recent groups are returned,
+       oldest first.
+
+  Side: The card lock is taken while copying.
+
+  Ret:  unsigned long
+             Number of samples copied
+
+=======================================================*/
+unsigned long drvHy8413_fifo_rd_chan( void * const     card_p,
+                                      unsigned short   chan,
+                                      unsigned short * const dst_a,
+                                      unsigned long    nelm )
+{
+  unsigned long         n;
+  unsigned long         i;
+  unsigned long         pos;
+  unsigned long         maxgrp;
+  unsigned short const *src_p;
+  IPADC_ID              card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->fifo_s.buf_a || (chan >= HY8413_NUM_CHAN) )
+     return( 0 );
+
+  epicsMutexMustLock( card_ps->lock );
+  maxgrp = card_ps->fifo_s.maxgrp;
+  n      = MIN( card_ps->fifo_s.nbuf, nelm );
+
+  /* Oldest requested group, the buffer is a ring */
+  pos   = drvHy8413_fifo_oldest( card_ps, n );
+  src_p = &card_ps->fifo_s.buf_a[pos * HY8413_NUM_CHAN + chan];
+  for (i=0; i<n; i++,pos++)
+  {
+    if ( pos == maxgrp )
+    {
+       pos   = 0;
+       src_p = &card_ps->fifo_s.buf_a[chan];
+    }
+    dst_a[i] = *src_p;
+    src_p   += HY8413_NUM_CHAN;
+  }
+  epicsMutexUnlock( card_ps->lock );
+  return( n );
+}
+
+/*====================================================
+
+  Abs:  Copy the sequence numbers of the captured samples
+
+  Name: drvHy8413_fifo_rd_seq
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        dst_a                           Sequence number array
+          Type: array
+          Use:  unsigned long long * const
+          Acc:  write-only
+          Mech: By reference
+
+        nelm                            Size of array
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function returns the sequence numbers of the
+       same sample groups as drvHy8413_fifo_rd_chan(), oldest
+       first. Consecutive samples whose sequence numbers
+       differ by more than one have lost samples between them.
+
+  Side: The card lock is taken while copying.
+
+  Ret:  unsigned long
+             Number of sequence numbers copied
+
+=======================================================*/
+unsigned long drvHy8413_fifo_rd_seq( void * const               card_p,
+                                     unsigned long long * const dst_a,
+                                     unsigned long              nelm )
+{
+  unsigned long         n;
+  unsigned long         i;
+  unsigned long         pos;
+  unsigned long         maxgrp;
+  IPADC_ID              card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->fifo_s.seq_a )
+     return( 0 );
+
+  epicsMutexMustLock( card_ps->lock );
+  maxgrp = card_ps->fifo_s.maxgrp;
+  n      = MIN( card_ps->fifo_s.nbuf, nelm );
+  pos    = drvHy8413_fifo_oldest( card_ps, n );
+  for (i=0; i<n; i++,pos++)
+  {
+    if ( pos == maxgrp )
+       pos = 0;
+    dst_a[i] = card_ps->fifo_s.seq_a[pos];
+  }
+  epicsMutexUnlock( card_ps->lock );
+  return( n );
+}
+
+/*====================================================
+
+  Abs:  Reset the external FIFO and arm in the requested mode
+
+  Name: drvHy8413_fifo_start
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        mode                            Acquisition mode
+          Type: enum                    Note: acq_capture
+          Use:  unsigned short                acq_stream
+                                              acq_pretrig
+                                              acq_segment
+                                              acq_soft
+          Acc:  read-only
+          Mech: By value
+
+        nreq                            Sample groups to read
+          Type: integer                 Note: 0=continuous
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function resets the external FIFO, empties the
+       card buffer and enables the trigger and the FIFO
+       interrupts. The acquisition is complete once the
+       requested number of sample groups has been read
+       (see drvHy8413_fifo_task).
+
+  Side: The module remains ARMed so that the adc buffer
+        registers continue to be updated.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, interrupts were not setup
+
+=======================================================*/
+static long drvHy8413_fifo_start( IPADC_ID       card_ps,
+                                  unsigned short mode,
+                                  unsigned long  nreq )
+{
+  int           key;
+  double        poll;
+  unsigned long len;
+  HY8413_IO     io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( !card_ps->intHandler || !card_ps->fifo_s.buf_a )
+     return( ERROR );
+
+  epicsMutexMustLock( card_ps->lock );
+  key = epicsInterruptLock();
+  io_ps->csr &= ~(HY8413_CSR_INT_MASK | HY8413_CSR_ET | HY8413_CSR_DRE);
+  epicsInterruptUnlock( key );
+
+  /* Pulse the FIFO reset */
+  io_ps->csr |= HY8413_CSR_RST;
+  io_ps->csr &= ~HY8413_CSR_RST;
+
+  /* 
+   * Poll at half the time it takes to fill a quarter
+   * of the FIFO, so the fullness counter never rolls
+   * over more than once between reads.
+   */
+  poll = ((double)(HY8413_FIFO_QTR/HY8413_NUM_CHAN)/drvHy8413_clk_hz(card_ps->io_p))/2.0;
+  if ( poll < epicsThreadSleepQuantum() )
+     poll = epicsThreadSleepQuantum();
+  else if ( poll > 1.0 )
+     poll = 1.0;
+  if ( ((mode == acq_segment) && card_ps->fifo_s.seglen) || (mode == acq_soft) )
+  {
+     /* 
+      * Short captures raise no FIFO interrupt, catch the end
+      * of each segment or capture early, the rest is discarded.
+      */
+     len  = (mode == acq_soft) ? nreq : card_ps->fifo_s.seglen;
+     poll = MIN( poll, ((double)len/drvHy8413_clk_hz(card_ps->io_p))/2.0 );
+     if ( poll < epicsThreadSleepQuantum() )
+        poll = epicsThreadSleepQuantum();
+  }
+
+  card_ps->fifo_s.mode  = mode;
+  card_ps->fifo_s.nreq  = nreq;
+  card_ps->fifo_s.trig  = 0;
+  card_ps->fifo_s.pre   = (mode == acq_pretrig);
+  card_ps->fifo_s.npre  = 0;
+  card_ps->fifo_s.trigIdx = 0;
+  card_ps->fifo_s.iseg  = 0;
+  card_ps->fifo_s.seq   = 0;
+  card_ps->fifo_s.left  = 0;
+  card_ps->fifo_s.lost  = 0;
+  card_ps->fifo_s.ngrp  = 0;
+  card_ps->fifo_s.wpos  = 0;
+  card_ps->fifo_s.nbuf  = 0;
+  card_ps->fifo_s.peak  = 0;
+  card_ps->fifo_s.poll  = poll;
+  card_ps->fifo_s.csr   = 0;
+  card_ps->fifo_s.state = fifo_armed;
+  epicsTimeGetCurrent( &card_ps->fifo_s.start );
+
+  key = epicsInterruptLock();
+  io_ps->csr |= card_ps->fifo_s.intMask | HY8413_CSR_ET | HY8413_CSR_ARM;
+  if ( card_ps->fifo_s.dma_ps && card_ps->fifo_s.dma_ps->dreq )
+     io_ps->csr |= HY8413_CSR_DRE;
+  epicsInterruptUnlock( key );
+  drvHy8413_snap_reg_touch( card_ps );
+  epicsMutexUnlock( card_ps->lock );
+
+  /* Streaming, segments and software triggers are paced by the drain task */
+  if ( (mode == acq_stream) || (mode == acq_segment) || (mode == acq_soft) )
+     epicsEventSignal( card_ps->fifo_s.evt );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Arm the external FIFO for a triggered capture
+
+  Name: drvHy8413_fifo_arm
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function arms the external FIFO to capture
+       one full FIFO of sample groups after the trigger.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, interrupts were not setup
+
+=======================================================*/
+long drvHy8413_fifo_arm( void * const card_p )
+{
+  return( drvHy8413_fifo_start( (IPADC_ID)card_p, acq_capture, HY8413_FIFO_NGRP ) );
+}
+
+/*====================================================
+
+  Abs:  Arm the external FIFO for a capture including pre-trigger samples
+
+  Name: drvHy8413_fifo_arm_pre
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function arms the external FIFO to capture one
+       full FIFO of sample groups after the trigger, preceded
+       by the contents of the pre-trigger FIFO. The trigger
+       is at sample npre of the capture (see fifo_item_npre).
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, interrupts were not setup
+
+=======================================================*/
+long drvHy8413_fifo_arm_pre( void * const card_p )
+{
+  return( drvHy8413_fifo_start( (IPADC_ID)card_p, acq_pretrig, HY8413_FIFO_NGRP ) );
+}
+
+/*====================================================
+
+  Abs:  Read an external FIFO status item
+
+  Name: drvHy8413_fifo_item
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-only
+          Mech: By reference
+
+        item                            Status item
+          Type: enum                    Note: see hy8413_fifoItem_te
+          Use:  unsigned short                in drvHy8413.h
+          Acc:  read-only
+          Mech: By value
+
+        val_p                           Item value
+          Type: integer
+          Use:  unsigned long * const
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function returns the trigger sample number,
+       the number of pre-trigger sample groups at the start
+       of the capture, the number of sample groups captured
+       or the number of segments completed since the FIFO
+       was armed. It also returns the sequence accounting of
+       the capture, the next sequence number and the groups
+       lost, each as two 32-bit words, and the overflow, gap
+       and timeout error counters of the card.
+
+       The sequence is 64 bits wide but longin records hold
+       32 bits, so SEQ and LOST wrap after 2^32 groups (about
+       12 hours at 100 kHz) and show negative past 2^31. The
+       msw items, SEQH and LOSTH, count the wraps. Clients
+       that only difference successive SEQ values should do so
+       modulo 2^32.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid item
+
+=======================================================*/
+long drvHy8413_fifo_item( void * const           card_p,
+                          unsigned short         item,
+                          unsigned long  * const val_p )
+{
+  long           status  = OK;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  epicsMutexMustLock( card_ps->lock );
+  switch( item )
+  {
+    case fifo_item_trig:
+      *val_p = card_ps->fifo_s.trigIdx;
+      break;
+
+    case fifo_item_npre:
+      *val_p = card_ps->fifo_s.npre;
+      break;
+
+    case fifo_item_ngrp:
+      *val_p = card_ps->fifo_s.ngrp;
+      break;
+
+    case fifo_item_nseg:
+      *val_p = card_ps->fifo_s.iseg;
+      break;
+
+    case fifo_item_seq:
+      *val_p = (unsigned long)(card_ps->fifo_s.seq & 0xffffffffULL);
+      break;
+
+    case fifo_item_lost:
+      *val_p = (unsigned long)(card_ps->fifo_s.lost & 0xffffffffULL);
+      break;
+
+    case fifo_item_ovf:
+      *val_p = card_ps->err_cnt_s.old_data;
+      break;
+
+    case fifo_item_gap:
+      *val_p = card_ps->err_cnt_s.inv_data;
+      break;
+
+    case fifo_item_tmo:
+      *val_p = card_ps->err_cnt_s.tmo;
+      break;
+
+    case fifo_item_seqh:
+      *val_p = (unsigned long)(card_ps->fifo_s.seq >> 32);
+      break;
+
+    case fifo_item_losth:
+      *val_p = (unsigned long)(card_ps->fifo_s.lost >> 32);
+      break;
+
+    default:
+      status = ERROR;
+      break;
+  }/* End of switch statement */
+  epicsMutexUnlock( card_ps->lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Arm the external FIFO for a streaming readout
+
+  Name: drvHy8413_fifo_stream
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        ngrp                            Sample groups to read
+          Type: integer                 Note: 0=continuous
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function arms the external FIFO and reads it
+       out while it is filling. This allows gapless captures
+       much longer than the FIFO. If more sample groups are
+       requested than the card buffer holds, the buffer is
+       reallocated to hold them all. A continuous stream
+       keeps the most recent sample groups in the buffer.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, no memory or interrupts not setup
+
+=======================================================*/
+long drvHy8413_fifo_stream( void * const card_p, unsigned long ngrp )
+{
+  IPADC_ID        card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->intHandler || !card_ps->fifo_s.buf_a )
+     return( ERROR );
+
+  if ( drvHy8413_fifo_grow( card_ps, ngrp ) )
+     return( ERROR );
+  return( drvHy8413_fifo_start( card_ps, acq_stream, ngrp ) );
+}
+
+/*====================================================
+
+  Abs:  Enlarge the card buffer
+
+  Name: drvHy8413_fifo_grow
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+        ngrp                            Sample groups to hold
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function reallocates the card buffer if it
+       holds fewer than the requested number of sample
+       groups. The current acquisition is stopped first.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Failure, no memory
+
+=======================================================*/
+static long drvHy8413_fifo_grow( IPADC_ID card_ps, unsigned long ngrp )
+{
+  int                 key;
+  unsigned short     *buf_a   = NULL;
+  unsigned long long *seq_a   = NULL;
+  HY8413_IO           io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( ngrp <= card_ps->fifo_s.maxgrp )
+     return( OK );
+
+  buf_a = calloc( ngrp * HY8413_NUM_CHAN, sizeof(unsigned short) );
+  seq_a = calloc( ngrp, sizeof(unsigned long long) );
+  if ( !buf_a || !seq_a )
+  {
+     errlogPrintf("IP8413: No memory for %lu sample groups - card %s\n",ngrp,card_ps->name_c);
+     free( buf_a );
+     free( seq_a );
+     return( ERROR );
+  }
+
+  /* Stop the current acquisition before swapping buffers */
+  epicsMutexMustLock( card_ps->lock );
+  key = epicsInterruptLock();
+  io_ps->csr &= ~(HY8413_CSR_INT_MASK | HY8413_CSR_ET | HY8413_CSR_DRE);
+  epicsInterruptUnlock( key );
+  drvHy8413_snap_reg_touch( card_ps );
+  card_ps->fifo_s.state = fifo_idle;
+  free( card_ps->fifo_s.buf_a );
+  free( card_ps->fifo_s.seq_a );
+  card_ps->fifo_s.buf_a  = buf_a;
+  card_ps->fifo_s.seq_a  = seq_a;
+  card_ps->fifo_s.maxgrp = ngrp;
+  card_ps->fifo_s.ngrp   = 0;
+  card_ps->fifo_s.wpos   = 0;
+  card_ps->fifo_s.nbuf   = 0;
+  epicsMutexUnlock( card_ps->lock );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Arm the external FIFO for a segmented capture
+
+  Name: drvHy8413_fifo_segment
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        nseg                            Number of segments
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        seglen                          Sample groups per segment
+          Type: integer                 Note: 1-HY8413_FIFO_NGRP
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function arms the external FIFO once to capture
+       nseg short segments of seglen sample groups, one per
+       trigger, back to back in the card buffer. The trigger
+       sample number and time of each segment are kept in the
+       segment table (see drvHy8413_fifo_seg). Only the data
+       of each segment is read over the bus.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid arguments, no memory or
+                     interrupts not setup
+
+=======================================================*/
+long drvHy8413_fifo_segment( void * const  card_p,
+                             unsigned long nseg,
+                             unsigned long seglen )
+{
+  hytec_ipmSeg_ts *seg_as  = NULL;
+  IPADC_ID         card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->intHandler || !card_ps->fifo_s.buf_a )
+     return( ERROR );
+  if ( !nseg || !seglen || (seglen > HY8413_FIFO_NGRP) )
+  {
+     errlogPrintf("IP8413: Invalid segments %lu x %lu groups - card %s\n",nseg,seglen,card_ps->name_c);
+     return( ERROR );
+  }
+  if ( drvHy8413_fifo_grow( card_ps, nseg * seglen ) )
+     return( ERROR );
+
+  epicsMutexMustLock( card_ps->lock );
+  if ( nseg > card_ps->fifo_s.maxseg )
+  {
+     seg_as = calloc( nseg, sizeof(hytec_ipmSeg_ts) );
+     if ( !seg_as )
+     {
+        epicsMutexUnlock( card_ps->lock );
+        errlogPrintf("IP8413: No memory for %lu segments - card %s\n",nseg,card_ps->name_c);
+        return( ERROR );
+     }
+     card_ps->fifo_s.state = fifo_idle;
+     free( card_ps->fifo_s.seg_as );
+     card_ps->fifo_s.seg_as = seg_as;
+     card_ps->fifo_s.maxseg = nseg;
+  }
+  card_ps->fifo_s.nseg   = nseg;
+  card_ps->fifo_s.seglen = seglen;
+  epicsMutexUnlock( card_ps->lock );
+  return( drvHy8413_fifo_start( card_ps, acq_segment, nseg * seglen ) );
+}
+
+/*====================================================
+
+  Abs:  Trigger information of a capture segment
+
+  Name: drvHy8413_fifo_seg
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-only
+          Mech: By reference
+
+        iseg                            Segment number
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+        trigIdx_p                       Trigger sample number
+          Type: integer
+          Use:  unsigned long * const
+          Acc:  write-only
+          Mech: By reference
+
+        time_p                          Trigger time
+          Type: struct
+          Use:  epicsTimeStamp * const
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function returns the trigger sample number and
+       time of a completed segment. The data of the segment
+       starts at sample iseg*seglen of the capture.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Segment not complete
+
+=======================================================*/
+long drvHy8413_fifo_seg( void * const            card_p,
+                         unsigned long           iseg,
+                         unsigned long  * const  trigIdx_p,
+                         epicsTimeStamp * const  time_p )
+{
+  long           status  = ERROR;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  epicsMutexMustLock( card_ps->lock );
+  if ( (card_ps->fifo_s.mode == acq_segment) && (iseg < card_ps->fifo_s.iseg) )
+  {
+     *trigIdx_p = card_ps->fifo_s.seg_as[iseg].trigIdx;
+     *time_p    = card_ps->fifo_s.seg_as[iseg].time;
+     status     = OK;
+  }
+  epicsMutexUnlock( card_ps->lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Arm and software trigger a short capture
+
+  Name: drvHy8413_fifo_soft
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        ngrp                            Sample groups to capture
+          Type: integer                 Note: 0=same as the last
+          Use:  unsigned long                 software capture
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function resets and arms the external FIFO for a
+       capture of ngrp sample groups and starts it at once by
+       setting the software trigger (ST). The drain task reads
+       the samples as they arrive and, once all have been read,
+       publishes them to the waveform records and signals the
+       completion event (see drvHy8413_fifo_snap). The function
+       does not wait for the capture to complete.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid length or interrupts not setup
+
+=======================================================*/
+long drvHy8413_fifo_soft( void * const card_p, unsigned long ngrp )
+{
+  int            key;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( !ngrp )
+     ngrp = card_ps->fifo_s.nsoft;
+  if ( !ngrp || (ngrp > HY8413_FIFO_NGRP) )
+  {
+     errlogPrintf("IP8413: Invalid software trigger capture of %lu groups - card %s\n",ngrp,card_ps->name_c);
+     return( ERROR );
+  }
+  card_ps->fifo_s.nsoft = ngrp;
+
+  /* Forget the completion of an earlier capture */
+  epicsEventTryWait( card_ps->fifo_s.done );
+  if ( drvHy8413_fifo_start( card_ps, acq_soft, ngrp ) )
+     return( ERROR );
+
+  key = epicsInterruptLock();
+  io_ps->csr |= HY8413_CSR_ST;
+  io_ps->csr &= ~HY8413_CSR_ST;
+  epicsInterruptUnlock( key );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Software triggered capture, wait for completion
+
+  Name: drvHy8413_fifo_snap
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        ngrp                            Sample groups to capture
+          Type: integer                 Note: 0=same as the last
+          Use:  unsigned long                 software capture
+          Acc:  read-only
+          Mech: By value
+
+        tmo                             Timeout (sec)
+          Type: float                   Note: 0=capture time
+          Use:  double                        plus one second
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function starts a software triggered capture (see
+       drvHy8413_fifo_soft) and waits until the samples have
+       been read and posted to the waveform records. On a
+       timeout the FIFO is stopped and the timeout counter
+       of the card incremented.
+
+  Side: Blocks the caller for up to tmo seconds. Only one
+        caller per card at a time.
+
+  Ret:  long
+             OK    - Capture complete
+             ERROR - Failed to start or timeout
+
+=======================================================*/
+long drvHy8413_fifo_snap( void * const  card_p,
+                          unsigned long ngrp,
+                          double        tmo )
+{
+  int            key;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( drvHy8413_fifo_soft( card_ps, ngrp ) )
+     return( ERROR );
+
+  if ( tmo <= 0.0 )
+     tmo = (double)card_ps->fifo_s.nsoft/drvHy8413_clk_hz( card_ps->io_p ) + 1.0;
+  if ( epicsEventWaitWithTimeout( card_ps->fifo_s.done, tmo ) == epicsEventWaitOK )
+     return( OK );
+
+  /* No trigger or no sample clock, stop the capture */
+  epicsMutexMustLock( card_ps->lock );
+  key = epicsInterruptLock();
+  io_ps->csr &= ~(HY8413_CSR_INT_MASK | HY8413_CSR_ET | HY8413_CSR_DRE);
+  epicsInterruptUnlock( key );
+  card_ps->fifo_s.state = fifo_idle;
+  card_ps->err_cnt_s.tmo++;
+  card_ps->err_cnt_s.cnt++;
+  epicsMutexUnlock( card_ps->lock );
+  errlogPrintf("IP8413: Software trigger capture timeout after %.3f sec - card %s\n",tmo,card_ps->name_c);
+  return( ERROR );
+}
+
+/*====================================================
+
+  Abs:  Sample clock rate in Hz
+
+  Name: drvHy8413_clk_hz
+
+  Args: io_p                            Base io address Card
+          Type: pointer
+          Use:  volatile unsigned short * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem: This function converts the clock rate register
+       setting into the sample rate in Hz.
+
+  Side: None
+
+  Ret:  double
+             Sample clock rate (Hz)
+
+=======================================================*/
+double drvHy8413_clk_hz( volatile unsigned short * const io_p )
+{
+  HY8413_IO  io_ps = (HY8413_IO)io_p;
+
+  return( clk_hz_a[io_ps->clk_rate & HY8413_CLK_RATE_MASK] );
+}
+
+/*====================================================
+
+  Abs:  Display FIFO readout information
+
+  Name: drvHy8413_fifo_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        interrupt and FIFO readout information of a card,
+        including the sustained readout throughput since
+        the FIFO was last armed. The peak number of sample
+        groups found in the FIFO at a drain shows how close
+        the readout came to losing data.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_fifo_report( void const * const card_p )
+{
+  double          elapsed = 0.0;
+  double          rate    = 0.0;
+  epicsTimeStamp  now;
+  IPADC_ID        card_ps = (IPADC_ID)card_p;
+  static const char *state_ac[3] = {"Idle","Armed","Done"};
+  static const char *mode_ac[HY8413_ACQ_NMODE] = {"Capture","Stream","Pre-trigger","Segment","Software"};
+
+  if ( !card_ps->intHandler ) return;
+
+  if ( card_ps->fifo_s.state == fifo_done )
+     now = card_ps->fifo_s.time;
+  else
+     epicsTimeGetCurrent( &now );
+  if ( card_ps->fifo_s.state != fifo_idle )
+     elapsed = epicsTimeDiffInSeconds( &now, &card_ps->fifo_s.start );
+  if ( elapsed > 0.0 )
+     rate = (double)card_ps->fifo_s.ngrp/elapsed;
+
+  printf("\tFIFO: vec: 0x%x  level: %d  interrupts: %lu  state: %s  mode: %s\n",
+         card_ps->intVec,
+         card_ps->intLevel,
+         card_ps->fifo_s.nint,
+         state_ac[card_ps->fifo_s.state],
+         mode_ac[card_ps->fifo_s.mode] );
+  printf("\t      groups: %lu (req %lu, buffer %lu)  peak fill: %lu of %d\n",
+         card_ps->fifo_s.ngrp,
+         card_ps->fifo_s.nreq,
+         card_ps->fifo_s.maxgrp,
+         card_ps->fifo_s.peak,
+         HY8413_FIFO_NGRP );
+  if ( card_ps->fifo_s.trig )
+    printf("\t      trigger sample: %lu  pre-trigger groups: %lu\n",
+           card_ps->fifo_s.trigIdx,
+           card_ps->fifo_s.npre );
+  if ( card_ps->fifo_s.mode == acq_segment )
+    printf("\t      segments: %lu of %lu, %lu groups each\n",
+           card_ps->fifo_s.iseg,
+           card_ps->fifo_s.nseg,
+           card_ps->fifo_s.seglen );
+  printf("\t      throughput: %.1f groups/s (%.3f MB/s) over %.3f s, clock %.0f Hz\n",
+         rate,
+         rate * HY8413_NUM_CHAN * sizeof(unsigned short) / 1.0e6,
+         elapsed,
+         drvHy8413_clk_hz( card_ps->io_p ) );
+  printf("\t      sequence: %llu  lost groups: %llu  overflows: %lu  gaps: %lu  timeouts: %lu\n",
+         card_ps->fifo_s.seq,
+         card_ps->fifo_s.lost,
+         card_ps->err_cnt_s.old_data,
+         card_ps->err_cnt_s.inv_data,
+         card_ps->err_cnt_s.tmo );
+  drvHy8413_dma_report( card_ps );
+  drvHy8413_ring_report( card_ps );
+  drvHy8413_wf_report( card_ps );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Arm the external FIFO of a card by name
+
+  Name: ip8413FifoArm
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  Shell wrapper for drvHy8413_fifo_arm().
+
+  Side: None
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found or interrupts not setup
+
+=======================================================*/
+long ip8413FifoArm( char const * const name_c )
+{
+  IPADC_ID  card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  return( drvHy8413_fifo_arm( card_ps ) );
+}
+
+/*====================================================
+
+  Abs:  Arm the external FIFO of a card with pre-trigger samples
+
+  Name: ip8413FifoArmPre
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  Shell wrapper for drvHy8413_fifo_arm_pre().
+
+  Side: None
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found or failed to arm
+
+=======================================================*/
+long ip8413FifoArmPre( char const * const name_c )
+{
+  IPADC_ID  card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  return( drvHy8413_fifo_arm_pre( card_ps ) );
+}
+
+/*====================================================
+
+  Abs:  Start streaming the external FIFO of a card by name
+
+  Name: ip8413FifoStream
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        msec                         Capture length (msec)
+          Type: integer              Note: 0=continuous
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Shell wrapper for drvHy8413_fifo_stream(). The
+        capture length is converted to sample groups
+        using the current clock rate.
+
+  Side: None
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found or failed to start
+
+=======================================================*/
+long ip8413FifoStream( char const * const name_c, int msec )
+{
+  unsigned long  ngrp    = 0;
+  IPADC_ID       card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( msec > 0 )
+     ngrp = (unsigned long)(drvHy8413_clk_hz( card_ps->io_p ) * msec / 1000.0) + 1;
+  return( drvHy8413_fifo_stream( card_ps, ngrp ) );
+}
+
+/*====================================================
+
+  Abs:  Arm a segmented capture of a card by name
+
+  Name: ip8413FifoSegment
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        nseg                         Number of segments
+          Type: integer
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+        seglen                       Sample groups per segment
+          Type: integer
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Shell wrapper for drvHy8413_fifo_segment().
+
+  Side: None
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found or failed to arm
+
+=======================================================*/
+long ip8413FifoSegment( char const * const name_c, int nseg, int seglen )
+{
+  IPADC_ID  card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( (nseg <= 0) || (seglen <= 0) )
+     return( ERROR );
+  return( drvHy8413_fifo_segment( card_ps, (unsigned long)nseg, (unsigned long)seglen ) );
+}
+
+/*====================================================
+
+  Abs:  Display the segments of a card by name
+
+  Name: ip8413FifoSegShow
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        start sample, trigger sample number and trigger
+        time of each completed segment.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found
+
+=======================================================*/
+long ip8413FifoSegShow( char const * const name_c )
+{
+  unsigned long   i;
+  unsigned long   trigIdx;
+  epicsTimeStamp  time;
+  char            time_c[MAX_CA_STRING_SIZE];
+  IPADC_ID        card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  printf("IP8413 %s: %lu of %lu segments, %lu groups each\n",
+         name_c,
+         card_ps->fifo_s.iseg,
+         card_ps->fifo_s.nseg,
+         card_ps->fifo_s.seglen );
+  for (i=0; drvHy8413_fifo_seg( card_ps, i, &trigIdx, &time )==OK; i++)
+  {
+     epicsTimeToStrftime( time_c, sizeof(time_c), "%Y-%m-%d %H:%M:%S.%06f", &time );
+     printf("\t%4lu: sample %8lu  trigger %10lu  %s\n",
+            i,
+            i * card_ps->fifo_s.seglen,
+            trigIdx,
+            time_c );
+  }
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Software triggered capture of a card by name
+
+  Name: ip8413FifoSnap
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        ngrp                         Sample groups to capture
+          Type: integer              Note: 0=same as the last
+          Use:  int                        software capture
+          Acc:  read-only
+          Mech: By value
+
+        msec                         Timeout (msec)
+          Type: integer              Note: 0=default
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Shell wrapper for drvHy8413_fifo_snap(), which also
+        displays how long the capture took.
+
+  Side: None
+
+  Ret:  long
+            OK    - Capture complete
+            ERROR - Card not found, failed to start or timeout
+
+=======================================================*/
+long ip8413FifoSnap( char const * const name_c, int ngrp, int msec )
+{
+  long      status  = ERROR;
+  IPADC_ID  card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( (ngrp < 0) || (msec < 0) )
+     return( ERROR );
+
+  status = drvHy8413_fifo_snap( card_ps, (unsigned long)ngrp, (double)msec/1000.0 );
+  if ( status == OK )
+     printf("IP8413 %s: %lu groups captured in %.3f ms\n",
+            name_c,
+            card_ps->fifo_s.ngrp,
+            epicsTimeDiffInSeconds( &card_ps->fifo_s.time, &card_ps->fifo_s.start )*1.0e3 );
+  return( status );
+}
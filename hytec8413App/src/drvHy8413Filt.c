@@ -0,0 +1,418 @@
+/*
+=============================================================
+
+  Abs:  Cascaded averaging filters for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Filt.c
+             drvHy8413_filt_config  - Configure the filter of a channel
+             drvHy8413_filt_update  - Filter a new set of averages
+             drvHy8413_filt_rd      - Read the filter output of a channel
+             drvHy8413_filt_report  - Display filter information
+             ip8413Filter           - Configure the filter of a channel (shell)
+
+  Rem:  The v2 firmware averager always averages 64 samples.
+        Longer integration windows are built on top of it in
+        software, one filter per channel, fed by the averager
+        watcher (see drvHy8413Sam.c) with each new average:
+
+          boxcar  - mean of the last N averages (N x 64 samples)
+          ema     - exponential moving average with a weight
+                    of 2^-N on the new average
+
+        Both are computed incrementally in 32-bit fixed point.
+        Calibrated averages are offset binary in both data
+        formats, raw two's complement averages are sign extended
+        so they average around zero. The boxcar keeps a running
+        sum of the last N averages, the ema keeps its state with
+        HY8413_FILT_EMAFRAC fraction bits. The output carries HY8413_FILT_FRAC fraction bits,
+        so the gain in resolution is not lost to rounding. It is
+        read by ai records with DTYP "Hytec IP-ADC-8413 Ave".
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "cantProceed.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+
+/*====================================================
+
+  Abs:  Configure the filter of a channel
+
+  Name: drvHy8413_filt_config
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        type                            Filter type
+          Type: enum                    Note: filt_none, filt_boxcar
+          Use:  unsigned short                or filt_ema
+          Acc:  read-only
+          Mech: By value
+
+        n                               Filter length
+          Type: integer                 Note: boxcar, 1 to
+          Use:  unsigned short                HY8413_FILT_MAXN averages
+          Acc:  read-only                     ema, weight 2^-n with n
+          Mech: By value                      1 to HY8413_FILT_MAXSHFT
+
+  Rem: This function sets the filter type and length of a
+       channel and restarts the filter. The boxcar history is
+       allocated once, for the longest boxcar.
+
+  Side: The snapshot lock is taken, the watcher updates the
+        filters while holding it.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid channel, type or length
+
+=======================================================*/
+long drvHy8413_filt_config( void * const    card_p,
+                            unsigned short  chan,
+                            unsigned short  type,
+                            unsigned short  n )
+{
+  hytec_ipmFilt_ts *filt_ps;
+  IPADC_ID          card_ps = (IPADC_ID)card_p;
+
+  if ( chan >= HY8413_NUM_CHAN ) return( ERROR );
+  if ( ((type == filt_boxcar) && ((n < 1) || (n > HY8413_FILT_MAXN))) ||
+       ((type == filt_ema) && ((n < 1) || (n > HY8413_FILT_MAXSHFT))) ||
+       (type >= HY8413_FILT_NTYPE) )
+  {
+    errlogPrintf("IP8413: Invalid filter type %hu length %hu for channel %hu\n",type,n,chan);
+    return( ERROR );
+  }
+
+  filt_ps = &card_ps->filt_as[chan];
+  if ( (type == filt_boxcar) && !filt_ps->hist_a )
+    filt_ps->hist_a = callocMustSucceed( HY8413_FILT_MAXN,
+                                         sizeof(long),
+                                         "drvHy8413_filt_config()" );
+
+  epicsMutexMustLock( card_ps->snap_s.lock );
+  filt_ps->type = type;
+  filt_ps->n    = n;
+  filt_ps->idx  = 0;
+  filt_ps->cnt  = 0;
+  filt_ps->acc  = 0;
+  filt_ps->out  = 0;
+  epicsMutexUnlock( card_ps->snap_s.lock );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Filter a new set of averages
+
+  Name: drvHy8413_filt_update
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function feeds the channel averages in the card
+       snapshot to the filter of each channel, calibrated when
+       calibration is enabled for the channel, as read_ai
+       reads them.
+
+       Calibrated averages are offset binary whatever the data
+       format, drvHy8413_cal_adc() returns 0 to 65535. Only raw
+       averages of a card in two's complement are sign extended,
+       to -32768 to 32767, so that the sum of averages either
+       side of zero volts is right. A filter restarts when its
+       channel switches between the two.
+
+       The boxcar replaces the oldest average in its running
+       sum, at most HY8413_FILT_MAXN x 65535, under 2^24. Its
+       output is the quotient and remainder of the sum by the
+       count, each scaled by HY8413_FILT_FRAC, so nothing
+       overflows 32 bits. The ema moves its state by 2^-n of
+       the difference to the new average, the first average
+       loads the state. With HY8413_FILT_EMAFRAC (14) fraction
+       bits the state and the difference stay within 2^30 and
+       the step only rounds to zero below 1/8 count. Both round
+       half away from zero.
+
+  Side: The caller must hold the snapshot lock.
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_filt_update( void * const card_p )
+{
+  unsigned short       c;
+  unsigned short       sgn;
+  long                 x;
+  long                 d;
+  unsigned long        m;
+  unsigned long        cnt;
+  hytec_ipmFilt_ts    *filt_ps;
+  hytec_ipmCalChan_ts *cal_ps;
+  IPADC_ID             card_ps = (IPADC_ID)card_p;
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    filt_ps = &card_ps->filt_as[c];
+    if ( filt_ps->type == filt_none ) continue;
+
+    /* Raw two's complement is signed, calibrated is offset binary */
+    cal_ps = &card_ps->cal_s.chan_as[c];
+    sgn    = (card_ps->format == twos_compliment) &&
+             !(cal_ps->enb && card_ps->cal_s.enb && cal_ps->init);
+    if ( sgn != filt_ps->sgn )
+    {
+      filt_ps->sgn = sgn;
+      filt_ps->idx = 0;
+      filt_ps->cnt = 0;
+      filt_ps->acc = 0;
+    }
+    if ( sgn )
+      x = (short)card_ps->snap_s.cal_a[c];
+    else
+      x = card_ps->snap_s.cal_a[c];
+
+    if ( filt_ps->type == filt_boxcar )
+    {
+      if ( filt_ps->cnt < filt_ps->n )
+        filt_ps->cnt++;
+      else
+        filt_ps->acc -= filt_ps->hist_a[filt_ps->idx];
+      filt_ps->hist_a[filt_ps->idx] = x;
+      filt_ps->acc += x;
+      if ( ++filt_ps->idx >= filt_ps->n ) filt_ps->idx = 0;
+
+      /* Mean of the magnitude, by quotient and remainder */
+      cnt = filt_ps->cnt;
+      m   = (filt_ps->acc >= 0) ? (unsigned long)filt_ps->acc : (unsigned long)-filt_ps->acc;
+      m   = ((m/cnt) << HY8413_FILT_FRAC) + (((m%cnt) << HY8413_FILT_FRAC) + cnt/2)/cnt;
+      filt_ps->out = (filt_ps->acc >= 0) ? (long)m : -(long)m;
+    }
+    else
+    {
+      d = x * (1L << HY8413_FILT_EMAFRAC);
+      if ( !filt_ps->cnt )
+      {
+        filt_ps->acc = d;
+        filt_ps->cnt = 1;
+      }
+      else
+      {
+        /* Round the step half away from zero, shifting a magnitude */
+        d -= filt_ps->acc;
+        if ( d >= 0 )
+          filt_ps->acc += (d + (1L << (filt_ps->n-1))) >> filt_ps->n;
+        else
+          filt_ps->acc -= (-d + (1L << (filt_ps->n-1))) >> filt_ps->n;
+      }
+      d = filt_ps->acc;
+      m = (d >= 0) ? (unsigned long)d : (unsigned long)-d;
+      m = (m + (1UL << (HY8413_FILT_EMAFRAC-HY8413_FILT_FRAC-1))) >> (HY8413_FILT_EMAFRAC-HY8413_FILT_FRAC);
+      filt_ps->out = (d >= 0) ? (long)m : -(long)m;
+    }
+    filt_ps->nupd++;
+  }
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Read the filter output of a channel
+
+  Name: drvHy8413_filt_rd
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        out_p                           Filter output
+          Type: integer                 Note: raw counts with
+          Use:  long *                        HY8413_FILT_FRAC
+          Acc:  write-only                    fraction bits
+          Mech: By reference
+
+        time_p                          Time of the last average
+          Type: pointer                 Note: may be NULL
+          Use:  epicsTimeStamp *
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function returns the filter output of a channel.
+       A boxcar that has not yet seen N averages returns the
+       mean of those it has.
+
+  Side: The snapshot lock is taken.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid channel, filter off or no average yet
+
+=======================================================*/
+long drvHy8413_filt_rd( void           * const card_p,
+                        unsigned short         chan,
+                        long           * const out_p,
+                        epicsTimeStamp * const time_p )
+{
+  long              status  = ERROR;
+  hytec_ipmFilt_ts *filt_ps;
+  IPADC_ID          card_ps = (IPADC_ID)card_p;
+
+  if ( chan >= HY8413_NUM_CHAN ) return( ERROR );
+
+  filt_ps = &card_ps->filt_as[chan];
+  epicsMutexMustLock( card_ps->snap_s.lock );
+  if ( (filt_ps->type != filt_none) && filt_ps->cnt )
+  {
+    *out_p = filt_ps->out;
+    if ( time_p ) *time_p = card_ps->snap_s.time;
+    status = OK;
+  }
+  epicsMutexUnlock( card_ps->snap_s.lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Display filter information
+
+  Name: drvHy8413_filt_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        filter type, integration window and output of the
+        channels with a filter configured.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_filt_report( void const * const card_p )
+{
+  unsigned short          c;
+  unsigned long           nsamp;
+  hytec_ipmFilt_ts const *filt_ps;
+  IPADC_ID                card_ps = (IPADC_ID)card_p;
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    filt_ps = &card_ps->filt_as[c];
+    if ( filt_ps->type == filt_none ) continue;
+
+    nsamp = HY8413_AVE_NSAMP * ((filt_ps->type == filt_boxcar) ? filt_ps->n : (1UL << filt_ps->n));
+    printf("\tFilter chan %2hu: %-6s n: %3hu  window: %lu samples  updates: %lu  output: %.3f\n",
+           c,
+           (filt_ps->type == filt_boxcar) ? "boxcar" : "ema",
+           filt_ps->n,
+           nsamp,
+           filt_ps->nupd,
+           (double)filt_ps->out/(1UL << HY8413_FILT_FRAC) );
+  }
+  return;
+}
+
+/*====================================================
+
+  Abs:  Configure the filter of a channel (shell)
+
+  Name: ip8413Filter
+
+  Args: name_c                          Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+        type                            Filter type
+          Type: integer                 Note: 0=off, 1=boxcar
+          Use:  int                           2=ema
+          Acc:  read-only
+          Mech: By value
+
+        n                               Filter length
+          Type: integer                 Note: boxcar of n averages
+          Use:  int                           or ema weight 2^-n
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Shell wrapper for drvHy8413_filt_config(). It may be
+        called before or after iocInit. For example, a boxcar
+        of 1024 samples (16 averages) on channel 3:
+
+            ip8413Filter("ADC0",3,1,16)
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Card not found or invalid arguments
+
+=======================================================*/
+long ip8413Filter( char const * const name_c, int chan, int type, int n )
+{
+  IPADC_ID  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( (chan < 0) || (type < 0) || (n < 0) ) return( ERROR );
+  return( drvHy8413_filt_config( card_ps, chan, type, n ) );
+}
@@ -24,7 +24,7 @@
 #define DRVHY8413LIB_H
 
 /* Interrupt Service Routine */ 
-void drvHy8413_isr( int param );                    /* module configuration infor     */
+void drvHy8413_isr( void * card_p );                /* module configuration infor     */
 
 /*
  * Write to the control register of specified card 
@@ -44,6 +44,17 @@ long drvHy8413_wt_acr(
           unsigned short                    val     /* state of mask bits to set      */
                     ); 
 
+/*
+ * Write bits of the auxilary control register of a card and
+ * follow a range or format change. Used for all ACR writes
+ * from records.
+ */
+long drvHy8413_acr_wt(
+          void                     * const  card_p, /* card info                      */
+          unsigned short                    mask,   /* bits to write                  */
+          unsigned short                    val     /* state of mask bits to set      */
+                    ); 
+
 /*
  * Set id prom page in auxilliary control register
  */
@@ -86,6 +97,14 @@ long drvHy8413_init_sam_mode(
           volatile unsigned short  * const  io_p    /* io base                       */
                       );
 
+/*
+ * Initilize the modules (v2 only) averager in polling mode,
+ * each average is acknowledged with ADN
+ */
+long drvHy8413_init_ave_mode(
+          volatile unsigned short  * const  io_p    /* io base                       */
+                      );
+
 
 /*
  * Read control status register
@@ -106,6 +125,17 @@ long drvHy8413_rd(
           short                    * const  val_p   /* adc data            */
                        );
 
+/*
+ * Read the 16 adc registers and the 0V and 2.5V references
+ * into an array of HY8413_ADC_NREG words, with 32-bit
+ * accesses if d32 is set. Returns the number of bus cycles.
+ */
+long drvHy8413_rd_block(
+          volatile unsigned short  * const  io_p,   /* io base address     */
+          unsigned short                    d32,    /* 32-bit accesses     */
+          unsigned short           * const  val_a   /* register values     */
+                       );
+
 /*
  * Display adc data to standard output.
  */
@@ -145,4 +175,750 @@ long  drvHy8413_cal_adc(
          long                         val
           );
 
+/*
+ * Setup interrupt driven readout of the external FIFO.
+ * Allocates the card buffer, starts the drain task and
+ * connects the interrupt service routine.
+ */
+long drvHy8413_fifo_init(
+          void           * const      card_p,    /* card info           */
+          unsigned long               mask       /* module setup mask   */
+          );
+
+/*
+ * Undo drvHy8413_fifo_init() after a failed card init:
+ * disable the FIFO interrupts and stop the drain task.
+ */
+long drvHy8413_fifo_stop(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Return the number of complete 16-channel sample
+ * groups available in the external FIFO.
+ */
+unsigned long drvHy8413_fifo_ngrp(
+          volatile unsigned short  * const  io_p    /* io base            */
+          );
+
+/*
+ * Read the available sample groups from the external
+ * FIFO into the card buffer. Returns the number read.
+ */
+unsigned long drvHy8413_fifo_drain(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Return the ring position of the oldest of the n most
+ * recent sample groups in the card buffer.
+ */
+unsigned long drvHy8413_fifo_oldest(
+          void           * const      card_p,    /* card info           */
+          unsigned long               n          /* number of groups    */
+          );
+
+/*
+ * Copy the most recent captured samples of one channel
+ * into an array. Returns the number of samples copied.
+ */
+unsigned long drvHy8413_fifo_rd_chan(
+          void           * const      card_p,    /* card info           */
+          unsigned short              chan,      /* channel number      */
+          unsigned short * const      dst_a,     /* sample array        */
+          unsigned long               nelm       /* size of array       */
+          );
+
+/*
+ * Copy the 64-bit sequence numbers of the sample groups
+ * returned by drvHy8413_fifo_rd_chan(). Returns the number
+ * copied.
+ */
+unsigned long drvHy8413_fifo_rd_seq(
+          void           * const      card_p,    /* card info           */
+          unsigned long long * const  dst_a,     /* sequence numbers    */
+          unsigned long               nelm       /* size of array       */
+          );
+
+/*
+ * Split interleaved sample groups into 16 channel arrays,
+ * optionally xor-ing each sample with HY8413_2C_FLIP to
+ * convert the data format. Uses the vector unit if present.
+ */
+void drvHy8413_deinterleave(
+          unsigned short const * const    src_a,  /* sample groups       */
+          unsigned long                   ngrp,   /* number of groups    */
+          unsigned short * const * const  dst_a,  /* 16 channel arrays   */
+          unsigned short                  xmask   /* 0 or HY8413_2C_FLIP */
+          );
+
+/*
+ * Reference per-sample version of drvHy8413_deinterleave().
+ */
+void drvHy8413_deinterleave_naive(
+          unsigned short const * const    src_a,  /* sample groups       */
+          unsigned long                   ngrp,   /* number of groups    */
+          unsigned short * const * const  dst_a,  /* 16 channel arrays   */
+          unsigned short                  xmask   /* 0 or HY8413_2C_FLIP */
+          );
+
+/*
+ * Copy the most recent captured samples of all channels
+ * into 16 arrays. Returns the number of samples per channel.
+ */
+unsigned long drvHy8413_fifo_rd_all(
+          void           * const          card_p, /* card info           */
+          unsigned short * const * const  dst_a,  /* 16 channel arrays   */
+          unsigned long                   nelm,   /* size of arrays      */
+          unsigned short                  xmask   /* 0 or HY8413_2C_FLIP */
+          );
+
+/*
+ * Allocate the waveform channel buffer pool.
+ */
+long drvHy8413_wf_init(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Deinterleave a completed capture into one pool buffer
+ * per channel. The caller must hold the card lock.
+ */
+long drvHy8413_wf_publish(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Swap a record buffer (HY8413_WF_NELM raw samples) for the
+ * channel buffer of the latest capture. Returns ERROR when
+ * the caller has to copy the samples instead.
+ */
+long drvHy8413_wf_take(
+          void           * const      card_p,    /* card info           */
+          unsigned short              chan,      /* channel number      */
+          void          ** const      buf_pp,    /* record buffer       */
+          unsigned long  * const      nord_p,    /* number of samples   */
+          unsigned long  * const      gen_p      /* capture generation  */
+          );
+
+/*
+ * Display waveform buffer pool information.
+ */
+void drvHy8413_wf_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Local memcpy stand-in for a carrier DMA engine.
+ */
+extern hytec_ipmDma_ts const drvHy8413_dma_local;
+
+/*
+ * Attach a carrier DMA engine to a card, NULL for
+ * programmed I/O. The FIFO must not be armed.
+ */
+long drvHy8413_dma_attach(
+          void           * const      card_p,    /* card info           */
+          hytec_ipmDma_ts const * const dma_ps   /* DMA engine          */
+          );
+
+/*
+ * Read words from the external FIFO port, by DMA if an
+ * engine is attached. The caller must hold the card lock.
+ */
+void drvHy8413_dma_rd(
+          void           * const      card_p,    /* card info           */
+          unsigned short * const      dst_p,     /* destination         */
+          unsigned long               nword      /* number of words     */
+          );
+
+/*
+ * Display DMA transfer information.
+ */
+void drvHy8413_dma_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Allocate the storage of an empty sample ring, rounded up
+ * to a power of two groups.
+ */
+long drvHy8413_ring_alloc(
+          hytec_ipmRing_ts * const    ring_ps,   /* ring                */
+          unsigned long               ngrp       /* capacity in groups  */
+          );
+
+/*
+ * Append sample groups to a ring, overwriting the oldest.
+ * Single producer, never blocks.
+ */
+void drvHy8413_ring_put(
+          hytec_ipmRing_ts * const    ring_ps,   /* ring                */
+          unsigned short const *      src_a,     /* sample groups       */
+          unsigned long               n          /* number of groups    */
+          );
+
+/*
+ * Read the oldest unread sample groups of a consumer, without
+ * a lock. Overwritten groups are skipped and counted.
+ */
+unsigned long drvHy8413_ring_get(
+          hytec_ipmRing_ts * const    ring_ps,   /* ring                */
+          unsigned short              id,        /* consumer number     */
+          unsigned short * const      dst_a,     /* sample groups       */
+          unsigned long               max        /* size in groups      */
+          );
+
+/*
+ * Create the sample ring of a card, filled by the drain task.
+ */
+long drvHy8413_ring_init(
+          void           * const      card_p,    /* card info           */
+          unsigned long               ngrp       /* capacity in groups  */
+          );
+
+/*
+ * Add a consumer to the sample ring of a card.
+ */
+long drvHy8413_ring_attach(
+          void           * const      card_p,    /* card info           */
+          char const     * const      name_c,    /* consumer name       */
+          unsigned short * const      id_p       /* consumer number     */
+          );
+
+/*
+ * Write drained sample groups to the card ring, if any.
+ */
+void drvHy8413_ring_write(
+          void           * const      card_p,    /* card info           */
+          unsigned short const *      src_a,     /* sample groups       */
+          unsigned long               n          /* number of groups    */
+          );
+
+/*
+ * Read sample groups of a consumer from the card ring.
+ */
+unsigned long drvHy8413_ring_read(
+          void           * const      card_p,    /* card info           */
+          unsigned short              id,        /* consumer number     */
+          unsigned short * const      dst_a,     /* sample groups       */
+          unsigned long               max        /* size in groups      */
+          );
+
+/*
+ * Display sample ring information.
+ */
+void drvHy8413_ring_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Reset the external FIFO and arm for a triggered capture.
+ */
+long drvHy8413_fifo_arm(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Reset the external FIFO and arm for a triggered capture
+ * that starts with the pre-trigger FIFO samples.
+ */
+long drvHy8413_fifo_arm_pre(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Reset the external FIFO and arm for nseg short captures
+ * of seglen sample groups, one per trigger.
+ */
+long drvHy8413_fifo_segment(
+          void           * const      card_p,    /* card info           */
+          unsigned long               nseg,      /* number of segments  */
+          unsigned long               seglen     /* groups per segment  */
+          );
+
+/*
+ * Return the trigger sample number and time of a
+ * completed segment.
+ */
+long drvHy8413_fifo_seg(
+          void           * const      card_p,    /* card info           */
+          unsigned long               iseg,      /* segment number      */
+          unsigned long  * const      trigIdx_p, /* trigger sample num  */
+          epicsTimeStamp * const      time_p     /* trigger time        */
+          );
+
+/*
+ * Reset the external FIFO, arm for ngrp sample groups
+ * (0=same as last time) and set the software trigger.
+ * Does not wait for the capture.
+ */
+long drvHy8413_fifo_soft(
+          void           * const      card_p,    /* card info           */
+          unsigned long               ngrp       /* sample groups       */
+          );
+
+/*
+ * Software triggered capture of ngrp sample groups, posted
+ * to the waveform records. Waits up to tmo seconds
+ * (0=default) and returns ERROR on a timeout.
+ */
+long drvHy8413_fifo_snap(
+          void           * const      card_p,    /* card info           */
+          unsigned long               ngrp,      /* sample groups       */
+          double                      tmo        /* timeout (sec)       */
+          );
+
+/*
+ * Read an external FIFO status item (hy8413_fifoItem_te).
+ */
+long drvHy8413_fifo_item(
+          void           * const      card_p,    /* card info           */
+          unsigned short              item,      /* status item         */
+          unsigned long  * const      val_p      /* item value          */
+          );
+
+/*
+ * Reset the external FIFO and read it out while it is
+ * filling, for ngrp sample groups (0=continuous).
+ */
+long drvHy8413_fifo_stream(
+          void           * const      card_p,    /* card info           */
+          unsigned long               ngrp       /* sample groups       */
+          );
+
+/*
+ * Return the sample clock rate in Hz.
+ */
+double drvHy8413_clk_hz(
+          volatile unsigned short  * const  io_p    /* io base            */
+          );
+
+/*
+ * Display FIFO readout information and throughput.
+ */
+void drvHy8413_fifo_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Arm the external FIFO of the named card (shell).
+ */
+long ip8413FifoArm(
+          char const * const name_c              /* card name           */
+          );
+
+/*
+ * Arm the external FIFO of the named card, with the
+ * pre-trigger samples at the start of the capture (shell).
+ */
+long ip8413FifoArmPre(
+          char const * const name_c              /* card name           */
+          );
+
+/*
+ * Stream the external FIFO of the named card for
+ * msec milliseconds, 0=continuous (shell).
+ */
+long ip8413FifoStream(
+          char const * const name_c,             /* card name           */
+          int                msec                /* capture length      */
+          );
+
+/*
+ * Benchmark the deinterleave of a full FIFO (shell).
+ */
+long ip8413DeintBench(
+          int                nloop               /* number of passes    */
+          );
+
+/*
+ * Arm a segmented capture of the named card (shell).
+ */
+long ip8413FifoSegment(
+          char const * const name_c,             /* card name           */
+          int                nseg,               /* number of segments  */
+          int                seglen              /* groups per segment  */
+          );
+
+/*
+ * Display the segments captured by the named card (shell).
+ */
+long ip8413FifoSegShow(
+          char const * const name_c              /* card name           */
+          );
+
+/*
+ * Use the local memcpy DMA stand-in (1) or programmed
+ * I/O (0) for the named card (shell).
+ */
+long ip8413DmaLocal(
+          char const * const name_c,             /* card name           */
+          int                enable              /* 1=local engine      */
+          );
+
+/*
+ * Test the local DMA stand-in (shell).
+ */
+long ip8413DmaTest(
+          int                nloop               /* number of passes    */
+          );
+
+/*
+ * Software triggered capture of the named card, waits for
+ * completion (shell).
+ */
+long ip8413FifoSnap(
+          char const * const name_c,             /* card name           */
+          int                ngrp,               /* sample groups       */
+          int                msec                /* timeout, 0=default  */
+          );
+
+/*
+ * Create the sample ring of the named card (shell).
+ */
+long ip8413RingCreate(
+          char const * const name_c,             /* card name           */
+          int                ngrp                /* capacity, 0=default */
+          );
+
+/*
+ * Test the sample ring with concurrent consumers (shell).
+ */
+long ip8413RingTest(
+          int                nloop               /* number of writes    */
+          );
+
+/*
+ * Benchmark single register reads against the block read
+ * of the named card (shell).
+ */
+long ip8413RdBench(
+          char const * const name_c,             /* card name           */
+          int                nloop               /* number of passes    */
+          );
+
+/*
+ * Acquire a new register snapshot of a card.
+ * The caller must hold the snapshot lock.
+ */
+long drvHy8413_snap_update(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * The two halves of drvHy8413_snap_update(): read the
+ * registers, then calibrate and publish the snapshot.
+ * The caller must hold the snapshot lock.
+ */
+long drvHy8413_snap_raw(
+          void           * const      card_p     /* card info           */
+          );
+long drvHy8413_snap_cal(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Read a channel (or HY8413_ADC_REF0/REF25) from the card
+ * snapshot, taking a new one if the caller already holds
+ * the current generation or it is too old.
+ */
+long drvHy8413_snap_rd(
+          void           * const      card_p,    /* card info           */
+          unsigned short              chan,      /* register index      */
+          unsigned short              cal,       /* calibrated channel  */
+          unsigned long  * const      gen_p,     /* generation held     */
+          short          * const      val_p,     /* register value      */
+          epicsTimeStamp * const      time_p     /* snapshot time, NULL */
+          );
+
+/*
+ * Read the ACR or CSR from the shadow of the card, reading
+ * both again if the caller already holds the shadow, and mark
+ * the shadow stale after either is written.
+ */
+long drvHy8413_snap_reg_rd(
+          void           * const      card_p,    /* card info           */
+          unsigned short              reg,       /* HY8413_REG_ACR/CSR  */
+          unsigned long  * const      gen_p,     /* generation held     */
+          unsigned short * const      val_p      /* register value      */
+          );
+
+void drvHy8413_snap_reg_touch(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Display register snapshot information.
+ */
+void drvHy8413_snap_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Start the averager watcher of a card, which requests the
+ * card I/O scan each time a new average is available.
+ */
+long drvHy8413_sam_start(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Display averager watcher information.
+ */
+void drvHy8413_sam_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Configure the software filter of a channel,
+ * type is a hy8413_filt_te.
+ */
+long drvHy8413_filt_config(
+          void           * const      card_p,    /* card info           */
+          unsigned short              chan,      /* channel number      */
+          unsigned short              type,      /* filter type         */
+          unsigned short              n          /* length or ema shift */
+          );
+
+/*
+ * Feed the averages in the card snapshot to the channel
+ * filters. The caller must hold the snapshot lock.
+ */
+long drvHy8413_filt_update(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Read the filter output of a channel, in raw counts
+ * with HY8413_FILT_FRAC fraction bits.
+ */
+long drvHy8413_filt_rd(
+          void           * const      card_p,    /* card info           */
+          unsigned short              chan,      /* channel number      */
+          long           * const      out_p,     /* filter output       */
+          epicsTimeStamp * const      time_p     /* average time, NULL */
+          );
+
+/*
+ * Display software filter information.
+ */
+void drvHy8413_filt_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Configure the software filter of a channel (shell).
+ */
+long ip8413Filter(
+          char const * const name_c,             /* card name           */
+          int                chan,               /* channel number      */
+          int                type,               /* 0=off 1=boxcar 2=ema*/
+          int                n                   /* length or ema shift */
+          );
+
+/*
+ * Calibrate a raw value of a channel, from the calibration
+ * table if built, otherwise with drvHy8413_cal_adc().
+ */
+long drvHy8413_cal_val(
+          void     const * const      card_p,    /* card info           */
+          unsigned short              chan,      /* channel number      */
+          unsigned short              rval       /* raw value           */
+          );
+
+/*
+ * Build the 65536 entry calibration table of each calibrated
+ * channel for the current range and format.
+ */
+long drvHy8413_cal_lut_build(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Set up the fixed-point segments of one channel from its
+ * calibration points, and of all channels of a card.
+ */
+void drvHy8413_cal_fix_set(
+          hytec_ipmCalFix_ts   * const fix_ps,   /* segments            */
+          unsigned short const * const gain_a,   /* calibration points  */
+          unsigned short               calType   /* 3 or 5-point        */
+          );
+
+long drvHy8413_cal_fix_build(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Calibrate a raw value with integer arithmetic only,
+ * bit-exact with drvHy8413_cal_adc().
+ */
+long drvHy8413_cal_fix(
+          hytec_ipmCalFix_ts const * const fix_ps, /* segments          */
+          unsigned short                   calType,/* 3 or 5-point      */
+          long                             rval    /* raw value         */
+          );
+
+/*
+ * Calibrate a block of samples of one channel, or of
+ * interleaved 16-channel groups, in one call. dst_a may
+ * be src_a.
+ */
+long drvHy8413_cal_chan_blk(
+          void           const * const card_p,   /* card info           */
+          unsigned short               chan,     /* channel number      */
+          unsigned short const * const src_a,    /* raw samples         */
+          unsigned short       * const dst_a,    /* calibrated samples  */
+          unsigned long                n         /* number of samples   */
+          );
+
+long drvHy8413_cal_grp_blk(
+          void           const * const card_p,   /* card info           */
+          unsigned short const * const src_a,    /* raw samples         */
+          unsigned short       * const dst_a,    /* calibrated samples  */
+          unsigned long                ngrp      /* number of groups    */
+          );
+
+/*
+ * Fold the calibration segments, data format and EGU range
+ * of a channel into coefficients, and convert a raw value
+ * with them, in EGU.
+ */
+long drvHy8413_cal_egu_set(
+          void           const * const card_p,   /* card info           */
+          unsigned short               chan,     /* channel number      */
+          double                       egul,     /* EGU at 0 counts     */
+          double                       eguf,     /* EGU at 65535 counts */
+          hytec_ipmCalEgu_ts   * const egu_ps    /* coefficients        */
+          );
+
+double drvHy8413_cal_egu(
+          void           const * const card_p,   /* card info           */
+          unsigned short               chan,     /* channel number      */
+          hytec_ipmCalEgu_ts   * const egu_ps,   /* coefficients        */
+          unsigned short               rval      /* raw value           */
+          );
+
+/*
+ * Copy the calibration data of the range in use, held for
+ * both ranges, to the channel calibration points.
+ */
+long drvHy8413_cal_range(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Read back range and format from the ACR and rebuild the
+ * calibration tables if they changed.
+ */
+long drvHy8413_cal_check(
+          void           * const      card_p     /* card info           */
+          );
+
+/*
+ * Display calibration table information.
+ */
+void drvHy8413_cal_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+/*
+ * Build (enable=1) or withdraw (enable=0) the calibration
+ * tables of a card (shell).
+ */
+long ip8413CalLut(
+          char const * const name_c,             /* card name           */
+          int                enable              /* use tables          */
+          );
+
+/*
+ * Use (enable=1) or drop (enable=0) the fixed-point
+ * calibration of a card (shell).
+ */
+long ip8413CalFix(
+          char const * const name_c,             /* card name           */
+          int                enable              /* use fixed point     */
+          );
+
+/*
+ * Compare the fixed-point and double calibration over all
+ * inputs and time both (shell). name_c may be NULL.
+ */
+long ip8413CalFixTest(
+          char const *       name_c,             /* card name or NULL   */
+          int                nloop               /* timing passes       */
+          );
+
+/*
+ * Check the block calibration against the double one and
+ * time it on 16 x 16384 samples (shell). name_c may be NULL.
+ */
+long ip8413CalBlkBench(
+          char const *       name_c,             /* card name or NULL   */
+          int                nloop               /* timing passes       */
+          );
+
+/*
+ * Calibration data cache file, keyed by module serial
+ * number, revision, id prom checksum, range and calibration
+ * type. The file is written by drvHy8413_cache_flush() during
+ * iocInit.
+ */
+long drvHy8413_cache_ld(
+          void           * const      card_p,    /* card info           */
+          unsigned short              range      /* voltage range       */
+          );
+
+long drvHy8413_cache_save(
+          void     const * const      card_p,    /* card info           */
+          unsigned short              range      /* voltage range       */
+          );
+
+long drvHy8413_cache_flush( void );
+
+long ip8413CalCache(
+          char const * const path_c              /* cache file name     */
+          );
+
+/*
+ * Calibration accuracy and throughput suite: all raw values,
+ * both formats, ranges and calibration types. Returns the
+ * largest deviation of drvHy8413_cal_adc() from the ideal
+ * calibration of each data format in dev_a, when not NULL.
+ */
+long drvHy8413_cal_bench(
+          char const *       name_c,             /* card name or NULL   */
+          int                nloop,              /* timing passes       */
+          double * const     dev_a               /* [2] by format       */
+          );
+
+/*
+ * Calibration accuracy and throughput suite (shell): all raw
+ * values, both formats, ranges and calibration types. name_c
+ * may be NULL for synthetic calibration points.
+ */
+long ip8413CalBench(
+          char const *       name_c,             /* card name or NULL   */
+          int                nloop               /* timing passes       */
+          );
+
+/*
+ * Drift correction from the on-board 0V and 2.5V references,
+ * folded into the calibration points.
+ */
+long drvHy8413_cal_trim(
+          void           * const      card_p,    /* card info           */
+          double                      gain,      /* gain trim           */
+          double                      off        /* offset trim, counts */
+          );
+
+void drvHy8413_drift_report(
+          void     const * const      card_p     /* card info           */
+          );
+
+long ip8413Drift(
+          char const * const name_c,             /* card name           */
+          int                shft                /* ema weight 2^-shft  */
+          );
+
 #endif /* DRVHY8413LIB_H */
@@ -0,0 +1,752 @@
+/*
+=============================================================
+
+  Abs:  Multi-consumer sample ring for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Ring.c
+             drvHy8413_ring_alloc   - Allocate the storage of a ring
+             drvHy8413_ring_put     - Write sample groups to a ring
+             drvHy8413_ring_get     - Read sample groups from a ring
+             drvHy8413_ring_init    - Create the sample ring of a card
+             drvHy8413_ring_attach  - Add a consumer to the sample ring of a card
+             drvHy8413_ring_write   - Write drained sample groups to the card ring
+             drvHy8413_ring_read    - Read sample groups from the card ring
+             drvHy8413_ring_report  - Display sample ring information
+          *  drvHy8413_ring_test_task - Consumer task of the ring test
+             ip8413RingCreate       - Create the sample ring of a card by name (shell)
+             ip8413RingTest         - Test the ring with concurrent consumers (shell)
+
+          * indicates static routines
+
+  Rem:  The drain task is the only producer of the ring. Each
+        consumer (waveforms, statistics, feedback, post-mortem)
+        has its own read position and reads without taking a
+        lock, so a slow consumer never holds up the drain task
+        or the other consumers. Instead the producer never waits:
+        a consumer that falls more than a ring behind loses the
+        oldest groups, which are counted as overwritten.
+
+        The producer first advances the write position (wr),
+        copies the groups, then advances the head. A consumer
+        copies up to the head it read, then checks wr again and
+        drops any group the producer may have started to
+        overwrite in the meantime, so no torn group is returned.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+#define HY8413_GRP_BCNT  (HY8413_NUM_CHAN * sizeof(unsigned short))
+
+/* Ring test, consumer task arguments */
+typedef struct hy8413_ringTest_s
+{
+    hytec_ipmRing_ts    *ring_ps;   /* ring under test                      */
+    unsigned short       id;        /* consumer number                      */
+    unsigned long        max;       /* groups per read                      */
+    unsigned long        nerr;      /* groups with the wrong samples        */
+    volatile int        *stop_p;    /* producer finished                    */
+    epicsEventId         done;      /* consumer finished                    */
+} hy8413_ringTest_ts;
+
+/* Local Prototypes */
+static void drvHy8413_ring_test_task( void * arg_p );
+
+
+/*====================================================
+
+  Abs:  Allocate the storage of a ring
+
+  Name: drvHy8413_ring_alloc
+
+  Args: ring_ps                         Ring
+          Type: pointer
+          Use:  hytec_ipmRing_ts * const
+          Acc:  read-write
+          Mech: By reference
+
+        ngrp                            Capacity in sample groups
+          Type: integer                 Note: rounded up to a
+          Use:  unsigned long                 power of two
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function allocates the group storage of an empty
+       ring. The storage is published last, so the producer
+       may already be checking for it.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Ring exists, invalid size or no memory
+
+=======================================================*/
+long drvHy8413_ring_alloc( hytec_ipmRing_ts * const ring_ps, unsigned long ngrp )
+{
+  unsigned long   n = 1;
+  unsigned short *buf_a = NULL;
+
+  if ( ring_ps->buf_a || !ngrp || (ngrp > 0x40000000UL) )
+     return( ERROR );
+  while ( n < ngrp )
+    n <<= 1;
+
+  buf_a = calloc( n, HY8413_GRP_BCNT );
+  if ( !buf_a )
+     return( ERROR );
+
+  ring_ps->ngrp  = n;
+  ring_ps->head  = 0;
+  ring_ps->wr    = 0;
+  ring_ps->ncons = 0;
+  HY8413_WMB();
+  ring_ps->buf_a = buf_a;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Write sample groups to a ring
+
+  Name: drvHy8413_ring_put
+
+  Args: ring_ps                         Ring
+          Type: pointer
+          Use:  hytec_ipmRing_ts * const
+          Acc:  read-write
+          Mech: By reference
+
+        src_a                           Sample groups
+          Type: array
+          Use:  unsigned short const *
+          Acc:  read-only
+          Mech: By reference
+
+        n                               Number of groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function appends n sample groups to the ring,
+       overwriting the oldest. It never waits for consumers.
+
+  Side: Only one producer per ring.
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_ring_put( hytec_ipmRing_ts * const ring_ps,
+                         unsigned short const *   src_a,
+                         unsigned long            n )
+{
+  unsigned long   head;
+  unsigned long   pos;
+  unsigned long   n1;
+
+  if ( !ring_ps->buf_a || !n )
+     return;
+
+  /* Only the newest ring of groups can be kept */
+  head = ring_ps->head;
+  if ( n > ring_ps->ngrp )
+  {
+     src_a += (n - ring_ps->ngrp) * HY8413_NUM_CHAN;
+     head  += n - ring_ps->ngrp;
+     n      = ring_ps->ngrp;
+  }
+
+  /* Claim the slots before overwriting them */
+  ring_ps->wr = head + n;
+  HY8413_WMB();
+
+  pos = head & (ring_ps->ngrp - 1);
+  n1  = MIN( n, ring_ps->ngrp - pos );
+  memcpy( &ring_ps->buf_a[pos * HY8413_NUM_CHAN], src_a, n1 * HY8413_GRP_BCNT );
+  if ( n1 < n )
+     memcpy( ring_ps->buf_a, &src_a[n1 * HY8413_NUM_CHAN], (n - n1) * HY8413_GRP_BCNT );
+
+  HY8413_WMB();
+  ring_ps->head = head + n;
+  return;
+}
+
+/*====================================================
+
+  Abs:  Read sample groups from a ring
+
+  Name: drvHy8413_ring_get
+
+  Args: ring_ps                         Ring
+          Type: pointer
+          Use:  hytec_ipmRing_ts * const
+          Acc:  read-write
+          Mech: By reference
+
+        id                              Consumer number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        dst_a                           Sample groups
+          Type: array
+          Use:  unsigned short * const
+          Acc:  write-only
+          Mech: By reference
+
+        max                             Size of array in groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function copies the oldest unread groups of the
+       consumer, up to max, and advances its read position.
+       Groups that were overwritten before or while being
+       copied are skipped and counted. The groups returned
+       are consecutive and end at the new read position.
+
+  Side: Only one caller per consumer.
+
+  Ret:  unsigned long
+             Number of groups copied
+
+=======================================================*/
+unsigned long drvHy8413_ring_get( hytec_ipmRing_ts * const ring_ps,
+                                  unsigned short           id,
+                                  unsigned short * const   dst_a,
+                                  unsigned long            max )
+{
+  unsigned long          head;
+  unsigned long          wr;
+  unsigned long          tail;
+  unsigned long          n;
+  unsigned long          n1;
+  unsigned long          pos;
+  unsigned long          bad;
+  hytec_ipmRingCons_ts  *cons_ps;
+
+  if ( !ring_ps->buf_a || (id >= ring_ps->ncons) )
+     return( 0 );
+  cons_ps = &ring_ps->cons_as[id];
+
+  head = ring_ps->head;
+  HY8413_RMB();
+  tail = cons_ps->tail;
+  if ( head - tail > ring_ps->ngrp )
+  {
+     cons_ps->nover += head - tail - ring_ps->ngrp;
+     tail = head - ring_ps->ngrp;
+  }
+  n   = MIN( head - tail, max );
+  pos = tail & (ring_ps->ngrp - 1);
+  n1  = MIN( n, ring_ps->ngrp - pos );
+  memcpy( dst_a, &ring_ps->buf_a[pos * HY8413_NUM_CHAN], n1 * HY8413_GRP_BCNT );
+  if ( n1 < n )
+     memcpy( &dst_a[n1 * HY8413_NUM_CHAN], ring_ps->buf_a, (n - n1) * HY8413_GRP_BCNT );
+
+  /* Drop what the producer may have overwritten during the copy */
+  HY8413_RMB();
+  wr = ring_ps->wr;
+  if ( wr - tail > ring_ps->ngrp )
+  {
+     bad = wr - tail - ring_ps->ngrp;
+     cons_ps->nover += bad;
+     if ( bad >= n )
+     {
+        tail = wr - ring_ps->ngrp;
+        n    = 0;
+     }
+     else
+     {
+        memmove( dst_a, &dst_a[bad * HY8413_NUM_CHAN], (n - bad) * HY8413_GRP_BCNT );
+        tail += bad;
+        n    -= bad;
+     }
+  }
+  cons_ps->tail   = tail + n;
+  cons_ps->nread += n;
+  return( n );
+}
+
+/*====================================================
+
+  Abs:  Create the sample ring of a card
+
+  Name: drvHy8413_ring_init
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        ngrp                            Capacity in sample groups
+          Type: integer                 Note: rounded up to a
+          Use:  unsigned long                 power of two
+          Acc:  read-only
+          Mech: By value
+
+  Rem: This function creates the sample ring of a card. From
+       then on the drain task writes every group it reads
+       from the FIFO to the ring.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Ring exists, invalid size or no memory
+
+=======================================================*/
+long drvHy8413_ring_init( void * const card_p, unsigned long ngrp )
+{
+  long           status;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  epicsMutexMustLock( card_ps->lock );
+  status = drvHy8413_ring_alloc( &card_ps->ring_s, ngrp );
+  epicsMutexUnlock( card_ps->lock );
+  if ( status )
+     errlogPrintf("IP8413: Unable to create a ring of %lu sample groups - card %s\n",ngrp,card_ps->name_c);
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Add a consumer to the sample ring of a card
+
+  Name: drvHy8413_ring_attach
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        name_c                          Consumer name
+          Type: char-string             Note: must remain valid
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        id_p                            Consumer number
+          Type: integer
+          Use:  unsigned short * const
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function adds a consumer to the ring of a card.
+       The consumer starts reading at the groups written
+       after this call.
+
+  Side: None
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - No ring or too many consumers
+
+=======================================================*/
+long drvHy8413_ring_attach( void * const            card_p,
+                            char const * const      name_c,
+                            unsigned short * const  id_p )
+{
+  long                   status  = ERROR;
+  hytec_ipmRingCons_ts  *cons_ps = NULL;
+  IPADC_ID               card_ps = (IPADC_ID)card_p;
+
+  epicsMutexMustLock( card_ps->lock );
+  if ( card_ps->ring_s.buf_a && (card_ps->ring_s.ncons < MAX_RING_CONS) )
+  {
+     cons_ps = &card_ps->ring_s.cons_as[card_ps->ring_s.ncons];
+     cons_ps->name_c = name_c;
+     cons_ps->tail   = card_ps->ring_s.head;
+     cons_ps->nread  = 0;
+     cons_ps->nover  = 0;
+     *id_p = card_ps->ring_s.ncons;
+     HY8413_WMB();
+     card_ps->ring_s.ncons++;
+     status = OK;
+  }
+  epicsMutexUnlock( card_ps->lock );
+  if ( status )
+     errlogPrintf("IP8413: Unable to add ring consumer %s - card %s\n",name_c,card_ps->name_c);
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Write drained sample groups to the card ring
+
+  Name: drvHy8413_ring_write
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        src_a                           Sample groups
+          Type: array
+          Use:  unsigned short const *
+          Acc:  read-only
+          Mech: By reference
+
+        n                               Number of groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: Called by the drain task for each run of groups read
+       from the FIFO. Nothing is done if the card has no ring.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_ring_write( void * const           card_p,
+                           unsigned short const * src_a,
+                           unsigned long          n )
+{
+  drvHy8413_ring_put( &((IPADC_ID)card_p)->ring_s, src_a, n );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Read sample groups from the card ring
+
+  Name: drvHy8413_ring_read
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        id                              Consumer number
+          Type: integer                 Note: from
+          Use:  unsigned short                drvHy8413_ring_attach()
+          Acc:  read-only
+          Mech: By value
+
+        dst_a                           Sample groups
+          Type: array
+          Use:  unsigned short * const
+          Acc:  write-only
+          Mech: By reference
+
+        max                             Size of array in groups
+          Type: integer
+          Use:  unsigned long
+          Acc:  read-only
+          Mech: By value
+
+  Rem: See drvHy8413_ring_get(). No lock is taken.
+
+  Side: Only one caller per consumer.
+
+  Ret:  unsigned long
+             Number of groups copied
+
+=======================================================*/
+unsigned long drvHy8413_ring_read( void * const           card_p,
+                                   unsigned short         id,
+                                   unsigned short * const dst_a,
+                                   unsigned long          max )
+{
+  return( drvHy8413_ring_get( &((IPADC_ID)card_p)->ring_s, id, dst_a, max ) );
+}
+
+/*====================================================
+
+  Abs:  Display sample ring information
+
+  Name: drvHy8413_ring_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        ring position and the counters of each consumer.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_ring_report( void const * const card_p )
+{
+  unsigned short               i;
+  hytec_ipmRingCons_ts const  *cons_ps = NULL;
+  IPADC_ID                     card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->ring_s.buf_a ) return;
+
+  printf("\t      ring: %lu groups  written: %lu  consumers: %hd\n",
+         card_ps->ring_s.ngrp,
+         card_ps->ring_s.head,
+         card_ps->ring_s.ncons );
+  for (i=0; i<card_ps->ring_s.ncons; i++)
+  {
+    cons_ps = &card_ps->ring_s.cons_as[i];
+    printf("\t\t%hd %-16s behind: %lu  read: %lu  overwritten: %lu\n",
+           i,
+           cons_ps->name_c,
+           card_ps->ring_s.head - cons_ps->tail,
+           cons_ps->nread,
+           cons_ps->nover );
+  }
+  return;
+}
+
+/*====================================================
+
+  Abs:  Consumer task of the ring test
+
+  Name: drvHy8413_ring_test_task
+
+  Args: arg_p                           Test arguments
+          Type: pointer
+          Use:  void *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: Reads the test ring until the producer is finished
+       and the ring is empty, checking that every sample of
+       a group holds the ring position of the group.
+
+  Side: None
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_ring_test_task( void * arg_p )
+{
+  int                  last = 0;
+  unsigned long        i;
+  unsigned long        n;
+  unsigned long        grp;
+  unsigned short       c;
+  unsigned short      *dst_a  = NULL;
+  hy8413_ringTest_ts  *test_ps = (hy8413_ringTest_ts *)arg_p;
+  hytec_ipmRing_ts    *ring_ps = test_ps->ring_ps;
+
+  dst_a = calloc( test_ps->max, HY8413_GRP_BCNT );
+  while ( dst_a )
+  {
+    n   = drvHy8413_ring_get( ring_ps, test_ps->id, dst_a, test_ps->max );
+    grp = ring_ps->cons_as[test_ps->id].tail - n;
+    for (i=0; i<n; i++,grp++)
+      for (c=0; c<HY8413_NUM_CHAN; c++)
+        if ( dst_a[i*HY8413_NUM_CHAN + c] != (unsigned short)(grp*HY8413_NUM_CHAN + c) )
+        {
+           test_ps->nerr++;
+           break;
+        }
+    if ( last && !n )
+       break;
+    last = *test_ps->stop_p;
+    if ( n < test_ps->max )
+       epicsThreadSleep( 0.0 );
+  }
+  free( dst_a );
+  epicsEventSignal( test_ps->done );
+  return;
+}
+
+/*====================================================
+
+  Abs:  Create the sample ring of a card by name
+
+  Name: ip8413RingCreate
+
+  Args: name_c                       Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+        ngrp                         Capacity in sample groups
+          Type: integer              Note: 0=one full FIFO
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  Shell wrapper for drvHy8413_ring_init().
+
+  Side: None
+
+  Ret:  long
+            OK    - Successful
+            ERROR - Card not found or ring not created
+
+=======================================================*/
+long ip8413RingCreate( char const * const name_c, int ngrp )
+{
+  IPADC_ID  card_ps = NULL;
+
+  card_ps = (IPADC_ID)hytec_ipmGetByName( name_c );
+  if ( !card_ps )
+  {
+     errlogPrintf("IP8413: Unable to find card %s\n",name_c);
+     return( ERROR );
+  }
+  if ( ngrp < 0 )
+     return( ERROR );
+  return( drvHy8413_ring_init( card_ps, ngrp ? (unsigned long)ngrp : HY8413_FIFO_NGRP ) );
+}
+
+/*====================================================
+
+  Abs:  Test the ring with concurrent consumers
+
+  Name: ip8413RingTest
+
+  Args: nloop                           Number of writes
+          Type: integer                 Note: default 10000
+          Use:  int
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This function writes nloop batches of numbered sample
+        groups to a small ring while three consumer tasks,
+        reading 1, 64 and 1024 groups at a time, check every
+        group they get. It displays how many groups each read
+        or lost, which must add up to the groups written, and
+        how many were torn, which must be none.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  long
+             OK    - Successful, no torn groups
+             ERROR - No memory or test failed
+
+=======================================================*/
+long ip8413RingTest( int nloop )
+{
+  long                 status = OK;
+  int                  i;
+  unsigned long        j;
+  unsigned long        n;
+  unsigned long        grp     = 0;
+  unsigned short      *src_a   = NULL;
+  volatile int        *stop_p  = NULL;
+  hytec_ipmRing_ts    *ring_ps = NULL;
+  hy8413_ringTest_ts  *test_as = NULL;
+  static const unsigned long max_a[3] = { 1, 64, 1024 };
+  static const char   *name_ac[3]     = { "single", "block", "bulk" };
+  const unsigned long  maxput = 512;
+
+  if ( nloop <= 0 ) nloop = 10000;
+
+  /* On the heap, in case a consumer task does not finish */
+  src_a   = calloc( maxput, HY8413_GRP_BCNT );
+  stop_p  = calloc( 1, sizeof(int) );
+  ring_ps = calloc( 1, sizeof(hytec_ipmRing_ts) );
+  test_as = calloc( 3, sizeof(hy8413_ringTest_ts) );
+  if ( !src_a || !stop_p || !ring_ps || !test_as || drvHy8413_ring_alloc( ring_ps, 4096 ) )
+  {
+     errlogPrintf("IP8413: No memory for ring test\n");
+     free( src_a );
+     free( (void *)stop_p );
+     free( ring_ps );
+     free( test_as );
+     return( ERROR );
+  }
+  for (i=0; i<3; i++)
+  {
+    ring_ps->cons_as[i].name_c = name_ac[i];
+    test_as[i].ring_ps = ring_ps;
+    test_as[i].id      = i;
+    test_as[i].max     = max_a[i];
+    test_as[i].stop_p  = stop_p;
+    test_as[i].done    = epicsEventMustCreate( epicsEventEmpty );
+  }
+  ring_ps->ncons = 3;
+  for (i=0; i<3; i++)
+    epicsThreadMustCreate( name_ac[i],
+                           epicsThreadPriorityMedium,
+                           epicsThreadGetStackSize(epicsThreadStackSmall),
+                           drvHy8413_ring_test_task,
+                           &test_as[i] );
+
+  /* Numbered groups in batches of 1 to maxput */
+  for (i=0; i<nloop; i++)
+  {
+    n = 1 + ((unsigned long)i * 2654435761UL >> 7) % maxput;
+    for (j=0; j<n*HY8413_NUM_CHAN; j++)
+      src_a[j] = (unsigned short)(grp*HY8413_NUM_CHAN + j);
+    drvHy8413_ring_put( ring_ps, src_a, n );
+    grp += n;
+    if ( !(i % 16) )
+      epicsThreadSleep( 0.0 );
+  }
+  *stop_p = 1;
+
+  printf("IP8413 ring test, %lu groups written to a ring of %lu\n",grp,ring_ps->ngrp);
+  for (i=0; i<3; i++)
+  {
+    if ( epicsEventWaitWithTimeout( test_as[i].done, 10.0 ) != epicsEventWaitOK )
+    {
+       printf("\tFAILED: consumer %s did not finish\n",name_ac[i]);
+       status = ERROR;
+       continue;
+    }
+    printf("\t%-6s (%4lu): read %9lu  overwritten %9lu  torn %lu\n",
+           name_ac[i],
+           max_a[i],
+           ring_ps->cons_as[i].nread,
+           ring_ps->cons_as[i].nover,
+           test_as[i].nerr );
+    if ( test_as[i].nerr || (ring_ps->cons_as[i].nread + ring_ps->cons_as[i].nover != grp) )
+    {
+       printf("\tFAILED: consumer %s\n",name_ac[i]);
+       status = ERROR;
+    }
+  }
+  free( src_a );
+  if ( status == OK )
+  {
+     for (i=0; i<3; i++)
+       epicsEventDestroy( test_as[i].done );
+     free( ring_ps->buf_a );
+     free( ring_ps );
+     free( test_as );
+     free( (void *)stop_p );
+  }
+  return( status );
+}
@@ -0,0 +1,340 @@
+/*
+=============================================================
+
+  Abs:  Averager watcher for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Sam.c
+             drvHy8413_sam_start    - Start the averager watcher of a card
+          *  drvHy8413_sam_swap     - Check for a SAM buffer swap
+          *  drvHy8413_sam_adn      - Read and acknowledge a polling mode average
+          *  drvHy8413_sam_task     - Averager watcher task
+             drvHy8413_sam_report   - Display averager watcher information
+
+          * indicates static routines
+
+  Rem:  In SAM Readout Mode the averager swaps its ping-pong
+        buffers each time a new set of averages is available
+        and toggles the BUF bit of the ACR. The module raises
+        no interrupt for it, so one task per card polls the
+        bit. On each swap the task takes a single register
+        snapshot (see drvHy8413Snap.c) and requests the I/O
+        scan of the card, so I/O Intr ai records are processed
+        once per new average and all read that snapshot.
+
+        With SAM off (polling mode) the averager sets ADN when
+        an average is done and stalls until software writes
+        ADN=1. The task then reads the averaged registers into
+        the snapshot, acknowledges at once so the next average
+        starts, and requests the scan in the same way. The time
+        between acknowledges, against the nominal averaging time,
+        gives the averager duty cycle.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+/* Local Prototypes */
+static int  drvHy8413_sam_swap( IPADC_ID card_ps );
+static int  drvHy8413_sam_adn( IPADC_ID card_ps );
+static void drvHy8413_sam_task( void *card_p );
+
+
+/*====================================================
+
+  Abs:  Check for a SAM buffer swap
+
+  Name: drvHy8413_sam_swap
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: If the BUF bit of the ACR changed, a snapshot of the
+       averaged data is taken. If the buffers swap again
+       while the snapshot is read, the snapshot may mix two
+       averages and is taken again. The snapshot is then fed
+       to the channel filters.
+
+       The BUF bit only tells an odd number of swaps from an
+       even one, so when the poll falls behind the averager
+       swaps are missed unseen. The number of swaps since the
+       last one seen is estimated from the averaging time and
+       any beyond the first are counted as overruns.
+
+  Side: The snapshot lock is taken.
+
+  Ret:  int
+             1 - New average in the snapshot
+             0 - No swap
+
+=======================================================*/
+static int drvHy8413_sam_swap( IPADC_ID card_ps )
+{
+  unsigned short buf;
+  double         nave;
+  epicsTimeStamp now;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  buf = io_ps->acr & HY8413_ACR_BUF;
+  if ( buf == card_ps->sam_s.buf ) return( 0 );
+
+  epicsMutexMustLock( card_ps->snap_s.lock );
+  drvHy8413_snap_update( card_ps );
+  if ( (io_ps->acr & HY8413_ACR_BUF) != buf )
+  {
+    buf = io_ps->acr & HY8413_ACR_BUF;
+    drvHy8413_snap_update( card_ps );
+    card_ps->sam_s.nredo++;
+  }
+  drvHy8413_filt_update( card_ps );
+  epicsMutexUnlock( card_ps->snap_s.lock );
+
+  epicsTimeGetCurrent( &now );
+  if ( card_ps->sam_s.nswap )
+  {
+    nave = epicsTimeDiffInSeconds( &now, &card_ps->sam_s.swap )/card_ps->sam_s.tave;
+    if ( nave > 1.5 )
+      card_ps->sam_s.novr += (unsigned long)(nave - 0.5);
+  }
+  card_ps->sam_s.swap = now;
+  card_ps->sam_s.buf  = buf;
+  card_ps->sam_s.nswap++;
+  return( 1 );
+}
+
+/*====================================================
+
+  Abs:  Read and acknowledge a polling mode average
+
+  Name: drvHy8413_sam_adn
+
+  Args: card_ps                         Card infomramtion
+          Type: pointer
+          Use:  IPADC_ID
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: If ADN is set, the averaged registers are read into
+       the snapshot and the average is acknowledged at once
+       by a write of ADN=1 followed by ADN=0, through
+       drvHy8413_acr_wt(), which restarts the averager. The
+       snapshot is calibrated after the acknowledge, while the
+       next average runs, and then fed to the channel filters.
+       The time since the previous acknowledge is added to
+       the measured cycle time.
+
+  Side: The snapshot lock is taken.
+
+  Ret:  int
+             1 - New average in the snapshot
+             0 - Average not done
+
+=======================================================*/
+static int drvHy8413_sam_adn( IPADC_ID card_ps )
+{
+  epicsTimeStamp now;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( !(io_ps->acr & HY8413_ACR_ADN) ) return( 0 );
+
+  epicsMutexMustLock( card_ps->snap_s.lock );
+  drvHy8413_snap_raw( card_ps );
+  drvHy8413_acr_wt( card_ps, HY8413_ACR_ADN, HY8413_ACR_ADN );
+  drvHy8413_acr_wt( card_ps, HY8413_ACR_ADN, 0 );
+  drvHy8413_snap_cal( card_ps );
+  drvHy8413_filt_update( card_ps );
+  epicsMutexUnlock( card_ps->snap_s.lock );
+
+  epicsTimeGetCurrent( &now );
+  if ( card_ps->sam_s.nswap )
+    card_ps->sam_s.tcycle += epicsTimeDiffInSeconds( &now, &card_ps->sam_s.ack );
+  card_ps->sam_s.ack = now;
+  card_ps->sam_s.nswap++;
+  return( 1 );
+}
+
+/*====================================================
+
+  Abs:  Averager watcher task
+
+  Name: drvHy8413_sam_task
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This task polls the BUF bit (SAM mode) or the ADN bit
+       (polling mode) of the ACR. Each time a new average is
+       in the snapshot, the card I/O scan is requested.
+
+  Side: Runs until the ioc is rebooted.
+
+  Ret:  None
+
+=======================================================*/
+static void drvHy8413_sam_task( void *card_p )
+{
+  int            new;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  card_ps->sam_s.buf = io_ps->acr & HY8413_ACR_BUF;
+  while (1)
+  {
+    epicsThreadSleep( card_ps->sam_s.poll );
+    if ( card_ps->sam_s.sam )
+      new = drvHy8413_sam_swap( card_ps );
+    else
+      new = drvHy8413_sam_adn( card_ps );
+    if ( new ) scanIoRequest( card_ps->fifo_s.ioscanpvt );
+  }
+}
+
+/*====================================================
+
+  Abs:  Start the averager watcher of a card
+
+  Name: drvHy8413_sam_start
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function starts the watcher task of a card with
+       the averager enabled, in SAM Readout Mode or polling
+       mode. In SAM mode the BUF bit is polled four times per
+       averaging period (64 samples at the card clock rate).
+       In polling mode the averager waits for each acknowledge,
+       so ADN is polled eight times per period to keep the
+       averager dead time short. The period is bounded by the
+       sleep quantum and one second.
+
+       Once bounded, a period longer than half the averaging
+       time can not follow the averager. In SAM mode swaps are
+       then missed, which is reported and counted as overruns
+       (see drvHy8413_sam_swap). In polling mode the averager
+       waits for the acknowledge, so nothing is lost, but its
+       duty cycle drops, which is reported. Lower the card
+       clock rate, or the sleep quantum, to avoid it.
+
+  Side: Called from drvHy8413_init_driver() during iocInit,
+        once the card lock and I/O scan have been created.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Averager not enabled
+
+=======================================================*/
+long drvHy8413_sam_start( void * const card_p )
+{
+  double         poll;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( !(io_ps->acr & HY8413_ACR_AEN) || card_ps->sam_s.tid ) return( ERROR );
+
+  card_ps->sam_s.sam  = (io_ps->acr & HY8413_ACR_SAM) ? 1 : 0;
+  card_ps->sam_s.tave = (double)HY8413_AVE_NSAMP/drvHy8413_clk_hz( card_ps->io_p );
+  poll = card_ps->sam_s.tave/(card_ps->sam_s.sam ? 4.0 : 8.0);
+  if ( poll < epicsThreadSleepQuantum() )
+     poll = epicsThreadSleepQuantum();
+  else if ( poll > 1.0 )
+     poll = 1.0;
+  card_ps->sam_s.poll = poll;
+  if ( poll > card_ps->sam_s.tave/2.0 )
+     errlogPrintf("IP8413: Averager poll %.4f s longer than half the %.6f s average, %s - card %s\n",
+                  poll,
+                  card_ps->sam_s.tave,
+                  card_ps->sam_s.sam ? "SAM swaps will be missed" : "averager dead time added",
+                  card_ps->name_c );
+  card_ps->sam_s.tid  = epicsThreadMustCreate( HY8413_SCAN_NAME,
+                                               HY8413_SCAN_PRI,
+                                               HY8413_SCAN_STACK,
+                                               drvHy8413_sam_task,
+                                               card_ps );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Display averager watcher information
+
+  Name: drvHy8413_sam_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        averager counters of a card. In polling mode the
+        duty cycle is the nominal averaging time over the
+        measured time between acknowledges, the rest is
+        averager dead time waiting for the acknowledge.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_sam_report( void const * const card_p )
+{
+  double         cycle   = 0.0;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->sam_s.tid ) return;
+
+  if ( card_ps->sam_s.sam )
+  {
+    printf("\tSAM: buffer %c  swaps: %lu  snapshots retaken: %lu  overruns: %lu  poll: %.4f s\n",
+           card_ps->sam_s.buf ? 'B' : 'A',
+           card_ps->sam_s.nswap,
+           card_ps->sam_s.nredo,
+           card_ps->sam_s.novr,
+           card_ps->sam_s.poll );
+    return;
+  }
+  if ( card_ps->sam_s.nswap > 1 )
+    cycle = card_ps->sam_s.tcycle/(card_ps->sam_s.nswap - 1);
+  printf("\tAverager (ADN): averages: %lu  poll: %.4f s  average: %.6f s  cycle: %.6f s  duty: %.1f%%  dead: %.6f s\n",
+         card_ps->sam_s.nswap,
+         card_ps->sam_s.poll,
+         card_ps->sam_s.tave,
+         cycle,
+         (cycle > 0.0) ? 100.0*card_ps->sam_s.tave/cycle : 0.0,
+         (cycle > card_ps->sam_s.tave) ? cycle - card_ps->sam_s.tave : 0.0 );
+  return;
+}
@@ -0,0 +1,403 @@
+/*
+=============================================================
+
+  Abs:  Register snapshot cache for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Snap.c
+             drvHy8413_snap_update  - Acquire a new snapshot of a card
+             drvHy8413_snap_raw     - Read the registers of a card into the snapshot
+             drvHy8413_snap_cal     - Calibrate and publish the snapshot of a card
+             drvHy8413_snap_rd      - Read a channel from the card snapshot
+             drvHy8413_snap_reg_rd  - Read the ACR or CSR from the card shadow
+             drvHy8413_snap_reg_touch - Mark the ACR and CSR shadow stale
+             drvHy8413_snap_report  - Display snapshot information
+
+  Rem:  The 16 adc buffer registers and both references of a
+        card are read together with drvHy8413_rd_block() into a
+        snapshot tagged with a generation number and a time
+        stamp. Analog input records read their channel from the
+        snapshot instead of the hardware, so a set of records
+        processed together sees values from the same conversion
+        cycle and a card costs one block read per pass instead
+        of one bus access per channel. The channels are
+        calibrated once per snapshot, with drvHy8413_cal_grp_blk(),
+        rather than once per record.
+
+        Each record keeps the generation it last read. A record
+        asking again for a generation it already holds starts
+        the next pass and a new snapshot is taken. The records
+        that follow in the same pass read that snapshot. A
+        snapshot older than HY8413_SNAP_MAXAGE is never served.
+
+        The bi, mbbi and mbbiDirect records on the ACR and CSR
+        read them the same way, from a shadow of both registers
+        with its own generation, so a pass over the status
+        records of a card costs two bus reads rather than one
+        per record. A write to either register through the
+        driver or the output records marks the shadow stale,
+        and the next read takes it again.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+
+/*====================================================
+
+  Abs:  Acquire a new snapshot of a card
+
+  Name: drvHy8413_snap_update
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function reads the adc and reference registers
+       of the card into the snapshot, calibrates the channels
+       with calibration enabled, and advances the snapshot
+       generation, skipping zero. It is drvHy8413_snap_raw()
+       followed by drvHy8413_snap_cal().
+
+  Side: The caller must hold the snapshot lock.
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_snap_update( void * const card_p )
+{
+  drvHy8413_snap_raw( card_p );
+  return( drvHy8413_snap_cal( card_p ) );
+}
+
+/*====================================================
+
+  Abs:  Read the registers of a card into the snapshot
+
+  Name: drvHy8413_snap_raw
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function reads the adc and reference registers
+       of the card into the raw values of the snapshot, the
+       first half of drvHy8413_snap_update(). The snapshot is
+       not valid until drvHy8413_snap_cal() is called, which
+       lets the averager watcher acknowledge an average as
+       soon as its registers are read.
+
+  Side: The caller must hold the snapshot lock.
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_snap_raw( void * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  card_ps->snap_s.ncyc += drvHy8413_rd_block( card_ps->io_p,
+                                              card_ps->d32,
+                                              card_ps->snap_s.val_a );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Calibrate and publish the snapshot of a card
+
+  Name: drvHy8413_snap_cal
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function calibrates the raw values read by
+       drvHy8413_snap_raw() for the channels with calibration
+       enabled, stamps the snapshot and advances its
+       generation, skipping zero.
+
+  Side: The caller must hold the snapshot lock.
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_snap_cal( void * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  drvHy8413_cal_grp_blk( card_ps, card_ps->snap_s.val_a, card_ps->snap_s.cal_a, 1 );
+  epicsTimeGetCurrent( &card_ps->snap_s.time );
+  if ( !++card_ps->snap_s.gen ) card_ps->snap_s.gen = 1;
+  card_ps->snap_s.nacq++;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Read a channel from the card snapshot
+
+  Name: drvHy8413_snap_rd
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        chan                            Register index
+          Type: integer                 Note: channel number, or
+          Use:  unsigned short                HY8413_ADC_REF0 or
+          Acc:  read-only                     HY8413_ADC_REF25
+          Mech: By value
+
+        cal                             Calibrated channel
+          Type: integer                 Note: 0 for the raw
+          Use:  unsigned short                register value
+          Acc:  read-only
+          Mech: By value
+
+        gen_p                           Record snapshot generation
+          Type: integer                 Note: 0 before the first
+          Use:  unsigned long *               read
+          Acc:  read-write
+          Mech: By reference
+
+        val_p                           Register value
+          Type: integer
+          Use:  short *
+          Acc:  write-only
+          Mech: By reference
+
+        time_p                          Snapshot time
+          Type: pointer                 Note: may be NULL
+          Use:  epicsTimeStamp *
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function returns the value of the register from
+       the snapshot of the card, calibrated if asked for a
+       channel with calibration enabled. A new snapshot is
+       taken first
+       if the caller already read the current one, or if it
+       is older than HY8413_SNAP_MAXAGE.
+
+  Side: The snapshot lock is taken.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid register index
+
+=======================================================*/
+long drvHy8413_snap_rd( void           * const card_p,
+                        unsigned short         chan,
+                        unsigned short         cal,
+                        unsigned long  * const gen_p,
+                        short          * const val_p,
+                        epicsTimeStamp * const time_p )
+{
+  epicsTimeStamp now;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  if ( chan >= HY8413_ADC_NREG ) return( ERROR );
+
+  epicsMutexMustLock( card_ps->snap_s.lock );
+  epicsTimeGetCurrent( &now );
+  if ( !card_ps->snap_s.gen || (*gen_p == card_ps->snap_s.gen) ||
+       (epicsTimeDiffInSeconds( &now, &card_ps->snap_s.time ) > HY8413_SNAP_MAXAGE) )
+    drvHy8413_snap_update( card_ps );
+  if ( cal && (chan < HY8413_NUM_CHAN) )
+    *val_p = (short)card_ps->snap_s.cal_a[chan];
+  else
+    *val_p = (short)card_ps->snap_s.val_a[chan];
+  *gen_p = card_ps->snap_s.gen;
+  if ( time_p ) *time_p = card_ps->snap_s.time;
+  card_ps->snap_s.nread++;
+  epicsMutexUnlock( card_ps->snap_s.lock );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Read the ACR or CSR from the card shadow
+
+  Name: drvHy8413_snap_reg_rd
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        reg                             Register
+          Type: integer                 Note: HY8413_REG_ACR or
+          Use:  unsigned short                HY8413_REG_CSR
+          Acc:  read-only
+          Mech: By value
+
+        gen_p                           Generation last read
+          Type: integer                 Note: 0 initially, updated
+          Use:  unsigned long *               to the generation read
+          Acc:  read-write
+          Mech: By reference
+
+        val_p                           Register value
+          Type: integer
+          Use:  unsigned short *
+          Acc:  write-only
+          Mech: By reference
+
+  Rem: This function returns the value of the register from
+       the shadow of the card. Both registers are read again
+       first if the caller already read the current shadow,
+       if it is older than HY8413_REG_MAXAGE, or if either
+       register was written since. The stale flag is cleared
+       before the registers are read, so a write made during
+       the read leaves it set.
+
+  Side: The snapshot lock is taken.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Invalid register
+
+=======================================================*/
+long drvHy8413_snap_reg_rd( void           * const card_p,
+                            unsigned short         reg,
+                            unsigned long  * const gen_p,
+                            unsigned short * const val_p )
+{
+  epicsTimeStamp now;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  HY8413_IO      io_ps   = (HY8413_IO)card_ps->io_p;
+
+  if ( reg > HY8413_REG_CSR ) return( ERROR );
+
+  epicsMutexMustLock( card_ps->snap_s.lock );
+  epicsTimeGetCurrent( &now );
+  if ( !card_ps->reg_s.gen || card_ps->reg_s.stale ||
+       (*gen_p == card_ps->reg_s.gen) ||
+       (epicsTimeDiffInSeconds( &now, &card_ps->reg_s.time ) > HY8413_REG_MAXAGE) )
+  {
+    card_ps->reg_s.stale = 0;
+    HY8413_WMB();
+    card_ps->reg_s.acr  = io_ps->acr;
+    card_ps->reg_s.csr  = io_ps->csr;
+    card_ps->reg_s.time = now;
+    card_ps->reg_s.gen++;
+    card_ps->reg_s.nacq++;
+  }
+  *val_p = (reg == HY8413_REG_CSR) ? card_ps->reg_s.csr : card_ps->reg_s.acr;
+  *gen_p = card_ps->reg_s.gen;
+  card_ps->reg_s.nread++;
+  epicsMutexUnlock( card_ps->snap_s.lock );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Mark the ACR and CSR shadow stale
+
+  Name: drvHy8413_snap_reg_touch
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function is called after the ACR or CSR of the
+       card has been written, so the next status read takes
+       both registers from the card again.
+
+  Side: No lock is taken, it may be called at interrupt
+        level.
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_snap_reg_touch( void * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  card_ps->reg_s.stale = 1;
+  return;
+}
+
+/*====================================================
+
+  Abs:  Display snapshot information
+
+  Name: drvHy8413_snap_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        snapshot counters of a card, and those of the ACR and
+        CSR shadow. The number of reads per snapshot shows how
+        many records share each block read.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_snap_report( void const * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+  char           time_c[40];
+
+  if ( card_ps->snap_s.nacq )
+  {
+    epicsTimeToStrftime( time_c, sizeof(time_c), "%Y-%m-%d %H:%M:%S.%06f", &card_ps->snap_s.time );
+    printf("\tSnapshot: generation %lu at %s  reads: %lu  reads/snapshot: %.1f  bus cycles: %lu\n",
+           card_ps->snap_s.gen,
+           time_c,
+           card_ps->snap_s.nread,
+           (double)card_ps->snap_s.nread/card_ps->snap_s.nacq,
+           card_ps->snap_s.ncyc );
+  }
+  if ( card_ps->reg_s.nacq )
+    printf("\tRegister shadow: generation %lu  reads: %lu  reads/bus read: %.1f\n",
+           card_ps->reg_s.gen,
+           card_ps->reg_s.nread,
+           (double)card_ps->reg_s.nread/card_ps->reg_s.nacq );
+  return;
+}
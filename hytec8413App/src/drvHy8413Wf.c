@@ -0,0 +1,258 @@
+/*
+=============================================================
+
+  Abs:  Waveform buffer pool for a VME Hytec ip-adc-8413 module
+
+  Name: drvHy8413Wf.c
+             drvHy8413_wf_init      - Allocate the channel buffer pool
+             drvHy8413_wf_publish   - Deinterleave a capture into pool buffers
+             drvHy8413_wf_take      - Swap a record buffer for the latest capture
+             drvHy8413_wf_report    - Display buffer pool information
+
+  Rem:  When a capture completes, the drain task deinterleaves
+        it once into one buffer per channel taken from a pool.
+        Raw (USHORT) waveform records of HY8413_WF_NELM elements
+        then swap their BPTR buffer with the channel buffer
+        instead of copying the samples. The buffer given up by
+        the record goes back to the pool. Since a buffer is only
+        ever exchanged for another one, the pool never runs dry.
+        Buffers of a capture that no record took are returned
+        to the pool when the next capture is published.
+
+  Proto: drvHy8413Lib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsVersion.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "cantProceed.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+#include "drvHy8413Lib.h"
+
+
+/*====================================================
+
+  Abs:  Allocate the channel buffer pool
+
+  Name: drvHy8413_wf_init
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function allocates HY8413_WF_NBUF buffers of
+       HY8413_WF_NELM samples, enough for two captures.
+
+  Side: Called from drvHy8413_fifo_init() prior to iocInit().
+
+  Ret:  long
+             OK    - Successful operation (always)
+
+=======================================================*/
+long drvHy8413_wf_init( void * const card_p )
+{
+  unsigned short i;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  for (i=0; i<HY8413_WF_NBUF; i++)
+    card_ps->wf_s.pool_a[i] = callocMustSucceed( HY8413_WF_NELM,
+                                                 sizeof(unsigned short),
+                                                 "drvHy8413_wf_init()" );
+  card_ps->wf_s.npool = HY8413_WF_NBUF;
+  memset( card_ps->wf_s.buf_a, 0, sizeof(card_ps->wf_s.buf_a) );
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Deinterleave a capture into pool buffers
+
+  Name: drvHy8413_wf_publish
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: This function returns the unclaimed buffers of the
+       previous capture to the pool, takes one buffer per
+       channel and deinterleaves the most recent sample
+       groups of the card buffer into them. The capture
+       generation is then advanced so that each record
+       takes the new buffer once.
+
+  Side: The caller must hold the card lock. Nothing is done
+        unless a record has registered for buffer swapping.
+
+  Ret:  long
+             OK    - Successful operation
+             ERROR - Not enough buffers in the pool
+
+=======================================================*/
+long drvHy8413_wf_publish( void * const card_p )
+{
+  unsigned short c;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->wf_s.nrec ) return( OK );
+
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+  {
+    if ( card_ps->wf_s.buf_a[c] )
+    {
+      card_ps->wf_s.pool_a[card_ps->wf_s.npool++] = card_ps->wf_s.buf_a[c];
+      card_ps->wf_s.buf_a[c] = NULL;
+    }
+  }
+  if ( card_ps->wf_s.npool < HY8413_NUM_CHAN )
+  {
+    card_ps->wf_s.nskip++;
+    return( ERROR );
+  }
+  for (c=0; c<HY8413_NUM_CHAN; c++)
+    card_ps->wf_s.buf_a[c] = card_ps->wf_s.pool_a[--card_ps->wf_s.npool];
+
+  card_ps->wf_s.nord = drvHy8413_fifo_rd_all( card_ps, card_ps->wf_s.buf_a, HY8413_WF_NELM, 0 );
+  card_ps->wf_s.gen++;
+  return( OK );
+}
+
+/*====================================================
+
+  Abs:  Swap a record buffer for the latest capture
+
+  Name: drvHy8413_wf_take
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void * const
+          Acc:  read-write
+          Mech: By reference
+
+        chan                            Channel number
+          Type: integer
+          Use:  unsigned short
+          Acc:  read-only
+          Mech: By value
+
+        buf_pp                          Record buffer
+          Type: pointer                 Note: HY8413_WF_NELM
+          Use:  void **                       raw samples
+          Acc:  read-write
+          Mech: By reference
+
+        nord_p                          Number of samples
+          Type: integer                 Note: unchanged if the
+          Use:  unsigned long *               record is current
+          Acc:  write-only
+          Mech: By reference
+
+        gen_p                           Record capture generation
+          Type: integer
+          Use:  unsigned long *
+          Acc:  read-write
+          Mech: By reference
+
+  Rem: If a capture newer than the one held by the record is
+       available, the record buffer is put in the pool and
+       replaced by the channel buffer of that capture. If the
+       record already holds the latest capture nothing is done.
+
+  Side: The card lock is taken.
+
+  Ret:  long
+             OK    - Record holds the latest capture
+             ERROR - Channel buffer already taken by another
+                     record, no capture or streaming, the caller
+                     must copy
+
+=======================================================*/
+long drvHy8413_wf_take( void * const            card_p,
+                        unsigned short          chan,
+                        void         ** const   buf_pp,
+                        unsigned long * const   nord_p,
+                        unsigned long * const   gen_p )
+{
+  long           status  = ERROR;
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  epicsMutexMustLock( card_ps->lock );
+  if ( card_ps->fifo_s.state != fifo_done )
+    card_ps->wf_s.ncopy++;
+  else if ( card_ps->wf_s.gen && (*gen_p == card_ps->wf_s.gen) )
+    status = OK;
+  else if ( card_ps->wf_s.buf_a[chan] && (card_ps->wf_s.npool < HY8413_WF_NBUF) )
+  {
+    card_ps->wf_s.pool_a[card_ps->wf_s.npool++] = (unsigned short *)*buf_pp;
+    *buf_pp = card_ps->wf_s.buf_a[chan];
+    card_ps->wf_s.buf_a[chan] = NULL;
+    *nord_p = card_ps->wf_s.nord;
+    *gen_p  = card_ps->wf_s.gen;
+    card_ps->wf_s.nswap++;
+    status = OK;
+  }
+  else
+    card_ps->wf_s.ncopy++;
+  epicsMutexUnlock( card_ps->lock );
+  return( status );
+}
+
+/*====================================================
+
+  Abs:  Display buffer pool information
+
+  Name: drvHy8413_wf_report
+
+  Args: card_p                          Card infomramtion
+          Type: pointer
+          Use:  void const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The purpose of this function is to display the
+        waveform buffer pool counters of a card.
+
+  Side: Report is sent to the standard output device
+
+  Ret:  None
+
+=======================================================*/
+void drvHy8413_wf_report( void const * const card_p )
+{
+  IPADC_ID       card_ps = (IPADC_ID)card_p;
+
+  if ( !card_ps->wf_s.npool && !card_ps->wf_s.nrec ) return;
+
+  printf("\t      wf pool: %hd of %d free  records: %hd  capture: %lu  swaps: %lu  copies: %lu  skipped: %lu\n",
+         card_ps->wf_s.npool,
+         HY8413_WF_NBUF,
+         card_ps->wf_s.nrec,
+         card_ps->wf_s.gen,
+         card_ps->wf_s.nswap,
+         card_ps->wf_s.ncopy,
+         card_ps->wf_s.nskip );
+  return;
+}
@@ -12,6 +12,7 @@
            * hytec_ipmInit       - Initialize card configuation structure
              hytec_ipmInitDev    - Initialize device structure 
 	   * hytec_analyzeINP    - Analyze input string.
+             hytec_ipmIsrParam   - Register a card for the interrupt handler
              hytec_ipmIsr        - Interrupt handler
              hytec_ipmReport     - Display card linked list information (output to stdio)
 	   * hytec_ipmValidate   - Validate IPAC module model at the given carrier & slot 
@@ -30,6 +31,12 @@
  
 -------------------------------------------------------------
   Mod:
+        17-Oct-2026, agent            (AGENT):
+           pass a card table index, not the card address, to hytec_ipmIsr
+           map the DATA bo to SetDATA in hytec_ipmInitDev
+           create the calibration lock with the snapshot lock
+           create the locks and scan lists before the model init,
+           do not free a failed card with its vector connected
         05-Dec-2007, K. Luchini        (LUCHINI):
            added TYPE_MBBO to hytec_ipmInitDev
  
@@ -37,6 +44,7 @@
 */ 
 /* Header Files */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
@@ -55,6 +63,8 @@
 
 /* Local variables */
 static ELLLIST cardList_s = {{ NULL,NULL },0};
+static IPADC_ID isrCard_a[HYTEC_MAX_ISR];   /* cards by hytec_ipmIsr param */
+static int      isrCnt = 0;
 
 /* Local Error Messages */
 static const char *cardErr_c     ="Card name was not specified!\n";
@@ -361,10 +371,21 @@ static long hytec_ipmCreate( char const * const name_c,
 	  /* add card to linked list */
           ellAdd( &cardList_s,(ELLNODE *)card_ps); 
        }
+       else if ( card_ps->intHandler )
+       {
+         /* 
+          * The interrupt vector stays connected to this card
+          * information, so it is kept rather than freed.
+          */
+         errlogPrintf ( initErr_c,carrier,slot  ); 
+       }
        else
        { 
          /* release memory before exiting */
          errlogPrintf ( initErr_c,carrier,slot  ); 
+         if ( card_ps->lock )        epicsMutexDestroy( card_ps->lock );
+         if ( card_ps->snap_s.lock ) epicsMutexDestroy( card_ps->snap_s.lock );
+         if ( card_ps->cal_s.lock )  epicsMutexDestroy( card_ps->cal_s.lock );
 	 if ( card_ps->name_c ) free(card_ps->name_c);
             free( card_ps );
        }
@@ -458,6 +479,22 @@ static long hytec_ipmInit( char const * const  name_c,
   /* Get firmware revision */
   card_ps->rev = card_ps->id_pu->hytec_s.revision;
 
+  /* 
+   * Locks and scan lists first, the model init may start
+   * the drain task and enable the card interrupt.
+   */
+  card_ps->lock  = epicsMutexMustCreate();
+  card_ps->snap_s.lock = epicsMutexMustCreate();
+  card_ps->cal_s.lock  = epicsMutexMustCreate();
+  scanIoInit(&card_ps->fifo_s.ioscanpvt);
+  scanIoInit(&card_ps->fifo_s.wfScan);
+  for (i=0; i<MAX_BITS; i++)
+  {
+    scanIoInit( &card_ps->mbbiScan_a[i] );
+    scanIoInit( &card_ps->biScan_a[ReadACR][i] );
+    scanIoInit( &card_ps->biScan_a[ReadCSR][i] );
+  }
+
   /* Perform special card initialization based on model */
   switch ( card_ps->model ) 
   {
@@ -469,19 +506,6 @@ static long hytec_ipmInit( char const * const  name_c,
        status = ERROR;
        break;
   }/* End of switch statement */
-
-  /* Setup some device support initialization for binary inputs */
-  if (status==OK ) 
-  {
-    card_ps->lock  = epicsMutexMustCreate();
-    scanIoInit(&card_ps->fifo_s.ioscanpvt);
-    for (i=0; i<MAX_BITS; i++)
-    {
-      scanIoInit( &card_ps->mbbiScan_a[i] );
-      scanIoInit( &card_ps->biScan_a[ReadACR][i] );
-      scanIoInit( &card_ps->biScan_a[ReadCSR][i] );
-    }
-  }
  
   return( status );
 } 
@@ -718,6 +742,13 @@ void * hytec_ipmInitDev( char const *  const          rec_name_c,
 	 devPvt_ps->card_ps = card_ps;
          devPvt_ps->i       = chan;
          devPvt_ps->func    = reg_type;
+         /*
+          * Only the software trigger bo writes. The other bo/mbbo
+          * register paths have always been read-back only, and
+          * enabling them would let PINI records write the card.
+          */
+         if ( (rec_type == TYPE_BO) && (reg_type == ReadDATA) )
+           devPvt_ps->func = SetDATA;
          devPvt_ps->recType = rec_type;
          devPvt_ps->nelm    = nelm;
        }
@@ -845,9 +876,74 @@ static long hytec_analyzeINP( char const      * const name_c,
 }
 
 
-void hytec_ipmIsr( int param )
+/*====================================================
+ 
+  Abs:  Register a card for the interrupt handler
+ 
+  Name: hytec_ipmIsrParam
+ 
+  Args: card_p                       Card configuration
+          Type: pointer
+          Use:  void * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem:  The routine parameter of ipmIntConnect() is an int,
+        which cannot hold the card address on a 64-bit host.
+        This function enters the card in a table and returns
+        its index, to be given to ipmIntConnect() as the
+        parameter of hytec_ipmIsr(). A card registered twice
+        keeps its index. Cards are registered before iocInit,
+        from one thread.
+ 
+  Side: None
+  
+  Ret:  int
+            index of the card, or -1 if the table is full
+            
+=======================================================*/ 
+int hytec_ipmIsrParam( void * const card_p )
 {
+  int i;
+
+  for (i=0; i<isrCnt; i++)
+    if ( isrCard_a[i] == (IPADC_ID)card_p ) return( i );
+  if ( isrCnt >= HYTEC_MAX_ISR ) return( -1 );
+  isrCard_a[isrCnt] = (IPADC_ID)card_p;
+  return( isrCnt++ );
+}
+
+/*====================================================
+ 
+  Abs:  Interrupt handler
+ 
+  Name: hytec_ipmIsr
+ 
+  Args: param                        Card table index
+          Type: integer              Note: from
+          Use:  int                        hytec_ipmIsrParam()
+          Acc:  read-only
+          Mech: By value
+
+  Rem:  This is the routine connected to the ip carrier
+        interrupt vector for each module. It dispatches
+        to the module specific interrupt service routine
+        registered in the card configuration (rtn_s.isr_pf),
+        with the card address.
+ 
+  Side: Called at interrupt level
   
+  Ret:  None
+            
+=======================================================*/ 
+void hytec_ipmIsr( int param )
+{
+  IPADC_ID card_ps;
+
+  if ( (param < 0) || (param >= isrCnt) ) return;
+  card_ps = isrCard_a[param];
+  if ( card_ps && card_ps->rtn_s.isr_pf )
+    ((void (*)(void *))card_ps->rtn_s.isr_pf)( card_ps );
   return;
 }
 
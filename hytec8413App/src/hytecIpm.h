@@ -10,6 +10,9 @@
              dbScan.h    - for IOSCANPVT
              epicsMux.h  - for epicsMutexId
              ellLib.h    - for ELLNODE
+             epicsEvent.h  - for epicsEventId
+             epicsThread.h - for epicsThreadId
+             epicsTime.h   - for epicsTimeStamp
 
   Auth: 19-Sep-2006, Kristi Luchini   (LUCHINI)
   Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
@@ -27,6 +30,9 @@
 #if (EPICS_REVISION == 14 && EPICS_MODIFICATION >= 11) || (EPICS_REVISION == 15) || (EPICS_VERSION == 7)
 #include "ellLib.h"
 #endif
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,12 +74,17 @@ extern "C" {
 #define MAX_VEC_NUM             255         /* maximum interrupt vector    */
 
 #define MAX_CA_STRING_SIZE      40
+#define HYTEC_MAX_ISR           64         /* cards with interrupts        */
 #define MAX_CHAN                16          /* maximum number of channels      */
 #define MAX_ID_PAGES            3           /* maximum number of ID PROM pages */
 #define MIN_CAL_PTS             3           /* minimum num of cal pts per chan */
 #define MAX_CAL_PTS             5           /* maximum num of cal pts per chan */
 #define NUM_CAL_TYPES           3           /* number of calibration  types    */
 #define CAL_MASK               0x3          /* mask for calibration type       */   
+#define MAX_WF_BUF             (2*MAX_CHAN) /* waveform buffers in pool        */
+#define MAX_RING_CONS           8           /* sample ring consumers per card  */
+#define MAX_SNAP_REG           (MAX_CHAN+2) /* adc and reference registers    */
+#define MAX_CAL_SEG             4           /* calibration segments per chan   */
 
 /************************************************************
 
@@ -192,11 +203,11 @@ typedef enum
 
 typedef struct  drvHytec_err_s
 {
-        unsigned short  cnt;             /* total count                              */
-        unsigned short  tmo;             /* timeout counter                          */
-        unsigned short  inv_data;        /* sequence error                           */
-        unsigned short  old_data;        /* data read from FIFO was old              */
-        unsigned short  too_many_int;    /* zero ticks passed since last interrupt   */
+        unsigned long   cnt;             /* total count                              */
+        unsigned long   tmo;             /* timeout counter                          */
+        unsigned long   inv_data;        /* sequence error                           */
+        unsigned long   old_data;        /* data read from FIFO was old              */
+        unsigned long   too_many_int;    /* zero ticks passed since last interrupt   */
 } hytec_ipmErr_ts;
 
 /************************************************************
@@ -205,6 +216,7 @@ typedef struct  drvHytec_err_s
 
 *************************************************************/
 #define NUM_FORMATS  2
+#define NUM_RANGES   2
 typedef struct hytec_ipmCalChan_s
 {
    unsigned short    init;      /* successfully read cal data      */
@@ -218,14 +230,98 @@ typedef struct hytec_ipmCalChan_s
    * formats.
    */
    unsigned short    gain_a[NUM_FORMATS][MAX_CAL_PTS];
+  /*
+   * The id prom holds one set of calibration data for each
+   * voltage range. Both are read at init, in offset binary,
+   * and the set of the range in use is copied to gain_a
+   * when the range changes.
+   */
+   unsigned short    rngInit;   /* ranges read, bit per range      */
+   unsigned short    rng_a[NUM_RANGES][MAX_CAL_PTS];
 } hytec_ipmCalChan_ts;
 
+/* 
+ * Fixed-point calibration of a channel, see drvHy8413Cal.c.
+ * Each segment is  offset + (raw - base) * slope  with the
+ * slope magnitude in Q32.
+ */
+typedef struct hytec_ipmCalSeg_s
+{
+   long               base;     /* raw value at the segment origin  */
+   long               offset;   /* calibrated value at the origin   */
+   short              sign;     /* sign of the slope, 0=zero scale  */
+   unsigned long long mc;       /* slope magnitude, rounded up      */
+   unsigned long long mf;       /* slope magnitude, rounded down    */
+} hytec_ipmCalSeg_ts;
+
+typedef struct hytec_ipmCalFix_s
+{
+   long               negHS;    /* segment breakpoints              */
+   long               zero;
+   long               posHS;
+   short              ordered;  /* negHS <= zero <= posHS           */
+   hytec_ipmCalSeg_ts seg_as[MAX_CAL_SEG];
+} hytec_ipmCalFix_ts;
+
+/*
+ * Direct engineering units conversion of a channel, see
+ * drvHy8413Cal.c. The calibration segments, the data format
+ * and EGUF/EGUL folded into  val = a + b * raw  per segment.
+ */
+typedef struct hytec_ipmCalEgu_s
+{
+   double             egul;     /* requested low and high EGU       */
+   double             eguf;
+   short              mode;     /* segments, or -1 if not folded   */
+   long               negHS;    /* segment breakpoints              */
+   long               zero;
+   long               posHS;
+   double             a_a[MAX_CAL_SEG];
+   double             b_a[MAX_CAL_SEG];
+   double             lo;       /* clip limits                      */
+   double             hi;
+   double             off;      /* EGU of 0 calibrated counts       */
+   double             k;        /* EGU per calibrated count         */
+   unsigned long      gen;      /* calibration generation used      */
+   unsigned short     format;   /* data format used                 */
+   unsigned short     range;    /* range used                       */
+   unsigned short     cal;      /* calibration was enabled          */
+} hytec_ipmCalEgu_ts;
+
 typedef struct  hytec_ipmCal_s
 {
     unsigned short       type;          /* calibration type                */
     unsigned short       enb;           /* calibrate enable                */
     short                npts;          /* number of calibration poits     */
+    unsigned short       range;         /* range of the data in gain_a     */
+    unsigned long        gen;           /* calibration generation          */
+    epicsMutexId         lock;          /* calibration data updates        */
+
+    /* Drift trim of the calibration points, see drvHy8413Drift.c */
+    volatile unsigned short trim;       /* trim applied                    */
+    unsigned short       trimRange;     /* range the trim is for           */
+    double               trimGain;      /* raw now = gain * raw then + off */
+    double               trimOff;
+    unsigned long        ntrim;         /* trims applied                   */
+
     hytec_ipmCalChan_ts  chan_as[MAX_CHAN];
+
+    /* Calibration tables, see drvHy8413Cal.c */
+    unsigned short      *lut_a[MAX_CHAN];  /* calibrated value of each raw */
+    unsigned short      *lutNext_a[MAX_CHAN]; /* spare, built then swapped */
+    volatile unsigned short lut;        /* tables in use                   */
+    unsigned short       lutFormat;     /* format the tables were built for*/
+    unsigned short       lutRange;      /* range the tables were built for */
+    unsigned long        lutBytes;      /* memory used by the tables       */
+    unsigned long        nbuild;        /* number of builds                */
+    epicsEventId         lutEvt;        /* table rebuild request           */
+    epicsThreadId        lutTid;        /* table rebuild task              */
+
+    /* Fixed-point calibration, see drvHy8413Cal.c */
+    hytec_ipmCalFix_ts   fix_as[MAX_CHAN];
+    volatile unsigned short fix;        /* fixed-point calibration in use  */
+    volatile unsigned short fixSet;     /* segments set up                 */
+    unsigned short       fixFormat;     /* format the segments are for     */
 }hytec_ipmCal_ts;
 
 /************************************************************
@@ -237,6 +333,70 @@ typedef struct  hytec_ipmCal_s
 
 typedef void (*VOIDFUNPTR)(void);
 
+/* 
+ * Carrier DMA engine. The transfer routine blocks until nbyte
+ * bytes have been moved and returns ERROR only if the transfer
+ * was not started. A source that does not increment is a
+ * device port.
+ */
+typedef long (*HYTEC_DMAFUNPTR)( void                * ctx_p,
+                                 volatile void const * src_p,
+                                 unsigned short        srcInc,
+                                 void                * dst_p,
+                                 unsigned long         nbyte );
+
+typedef struct hytec_ipmDma_s
+{
+    char const      *name_c;        /* engine name                          */
+    HYTEC_DMAFUNPTR  xfer_pf;       /* blocking transfer routine            */
+    void            *ctx_p;         /* engine context                       */
+    unsigned short   dreq;          /* paced by the module DMA request lines*/
+} hytec_ipmDma_ts;
+
+/* 
+ * Sample ring, one producer and up to MAX_RING_CONS consumers,
+ * see drvHy8413Ring.c. Positions count groups since the ring
+ * was created and wrap at 2^32.
+ */
+typedef struct hytec_ipmRingCons_s
+{
+    char const      *name_c;        /* consumer name                        */
+    unsigned long    tail;          /* next group to read                   */
+    unsigned long    nread;         /* groups read                          */
+    unsigned long    nover;         /* groups overwritten before read       */
+} hytec_ipmRingCons_ts;
+
+typedef struct hytec_ipmRing_s
+{
+    unsigned short  *buf_a;         /* ngrp groups of 16 samples            */
+    unsigned long    ngrp;          /* capacity, a power of two             */
+    volatile unsigned long head;    /* groups written                       */
+    volatile unsigned long wr;      /* groups written or being written      */
+    unsigned short   ncons;         /* number of consumers                  */
+    hytec_ipmRingCons_ts cons_as[MAX_RING_CONS];
+} hytec_ipmRing_ts;
+
+/* Software filter of a channel, see drvHy8413Filt.c */
+typedef struct hytec_ipmFilt_s
+{
+    unsigned short   type;          /* filter type, see hy8413_filt_te      */
+    unsigned short   n;             /* boxcar length or ema shift           */
+    unsigned short   idx;           /* next boxcar history entry            */
+    unsigned short   cnt;           /* averages in the boxcar, 1=ema loaded */
+    unsigned short   sgn;           /* averages are signed, raw 2C          */
+    long            *hist_a;        /* boxcar history                       */
+    long             acc;           /* boxcar sum or ema state, 32 bits     */
+    long             out;           /* output, fixed point                  */
+    unsigned long    nupd;          /* averages filtered                    */
+} hytec_ipmFilt_ts;
+
+/* Segment of a segmented FIFO capture */
+typedef struct hytec_ipmSeg_s
+{
+    unsigned long    trigIdx;       /* trigger sample number                */
+    epicsTimeStamp   time;          /* estimated trigger time               */
+} hytec_ipmSeg_ts;
+
 typedef struct hytec_ipmConfig_s {
 
   ELLNODE                 node;          /* Link List Node                  */
@@ -255,6 +415,7 @@ typedef struct hytec_ipmConfig_s {
   unsigned short          nchan;         /* Number of channels              */
   unsigned long           init;          /* initialize flag                 */
   unsigned char           intHandler;    /* interrupt handler flag          */
+  unsigned char           d32;           /* carrier allows 32-bit access    */
   int                     arm;
   epicsMutexId            lock;
   unsigned char           intVec;        /* interrupt vector                */
@@ -271,11 +432,129 @@ typedef struct hytec_ipmConfig_s {
   IOSCANPVT              calEnbScan;
   struct 
   {
-    unsigned short state;
-    IOSCANPVT      ioscanpvt;
-
+    unsigned short   state;         /* acquisition state                    */
+    unsigned short   mode;          /* acquisition mode                     */
+    unsigned short   trig;          /* trigger seen since armed             */
+    unsigned short   pre;           /* pre-trigger samples to be read       */
+    unsigned long    npre;          /* pre-trigger groups at buffer start   */
+    unsigned long    trigIdx;       /* trigger sample number                */
+    epicsTimeStamp   trigTime;      /* estimated trigger time               */
+    unsigned long    seglen;        /* sample groups per segment            */
+    unsigned long    nseg;          /* segments requested                   */
+    unsigned long    iseg;          /* segments completed                   */
+    unsigned long    maxseg;        /* segment table capacity               */
+    unsigned long    nsoft;         /* software trigger capture length      */
+    epicsEventId     done;          /* signaled when a capture completes    */
+    hytec_ipmSeg_ts *seg_as;        /* segment table                        */
+    IOSCANPVT        ioscanpvt;
+    IOSCANPVT        wfScan;        /* waveform records, new capture data   */
+    unsigned short   intMask;       /* csr interrupt enables when armed     */
+    unsigned short   csr;           /* csr latched at the last interrupt    */
+    unsigned long    nint;          /* interrupt counter                    */
+    unsigned long    ngrp;          /* sample groups drained since armed    */
+    unsigned long    nreq;          /* sample groups requested, 0=continuous*/
+    unsigned long    maxgrp;        /* buffer (ring) capacity in groups     */
+    unsigned long    wpos;          /* ring group written next              */
+    unsigned long    nbuf;          /* groups held in the ring, <= maxgrp   */
+    unsigned long    peak;          /* most groups found in FIFO at a drain */
+    double           poll;          /* streaming poll period (sec)          */
+    unsigned short  *buf_a;         /* drained data, 16 words per group     */
+    unsigned long long *seq_a;      /* sequence number of each group        */
+    unsigned long long  seq;        /* sequence number of the next group    */
+    unsigned long long  lost;       /* groups lost since armed (estimate)   */
+    unsigned long    left;          /* groups not read at the last drain    */
+    epicsTimeStamp   last;          /* time of the last drain               */
+    hytec_ipmDma_ts const *dma_ps;  /* carrier DMA engine, NULL=PIO         */
+    unsigned long    ndma;          /* words read by DMA                    */
+    unsigned long    npio;          /* words read by programmed I/O         */
+    unsigned long    dmaErr;        /* DMA transfers refused                */
+    epicsTimeStamp   start;         /* time armed                           */
+    epicsTimeStamp   time;          /* time of the last capture data        */
+    epicsEventId     evt;           /* isr to drain task signal             */
+    epicsThreadId    tid;           /* drain task                           */
+    volatile unsigned short quit;   /* drain task asked to exit             */
+    epicsEventId     exit;          /* signaled by the drain task on exit   */
   } fifo_s;
 
+  /* Waveform buffer pool, see drvHy8413Wf.c */
+  struct
+  {
+    unsigned short  *pool_a[MAX_WF_BUF]; /* free buffers                    */
+    unsigned short   npool;         /* number of free buffers               */
+    unsigned short   nrec;          /* records swapping buffers             */
+    unsigned short  *buf_a[MAX_CHAN];  /* latest capture, one per channel   */
+    unsigned long    nord;          /* samples per channel in capture       */
+    unsigned long    gen;           /* capture generation                   */
+    unsigned long    nswap;         /* buffers handed to records            */
+    unsigned long    ncopy;         /* reads that fell back to a copy       */
+    unsigned long    nskip;         /* captures not published               */
+  } wf_s;
+
+  /* Multi-consumer sample ring, filled by the drain task */
+  hytec_ipmRing_ts        ring_s;
+
+  /* Register snapshot read by ai records, see drvHy8413Snap.c */
+  struct
+  {
+    unsigned short   val_a[MAX_SNAP_REG]; /* adc registers and references  */
+    unsigned short   cal_a[MAX_CHAN]; /* channels, calibrated when enabled   */
+    unsigned long    gen;           /* snapshot generation, 0=none          */
+    epicsTimeStamp   time;          /* time of the snapshot                 */
+    epicsMutexId     lock;
+    unsigned long    nacq;          /* snapshots taken                      */
+    unsigned long    nread;         /* reads served                         */
+    unsigned long    ncyc;          /* bus cycles used                      */
+  } snap_s;
+
+  /* Shadow of the ACR and CSR read by status records, see drvHy8413Snap.c */
+  struct
+  {
+    unsigned short   acr;
+    unsigned short   csr;
+    volatile unsigned short stale;  /* a register was written since read    */
+    unsigned long    gen;           /* shadow generation, 0=none            */
+    epicsTimeStamp   time;          /* time of the shadow                   */
+    unsigned long    nacq;          /* register pairs read from the card    */
+    unsigned long    nread;         /* reads served                         */
+  } reg_s;
+
+  /* Averager watcher, SAM buffer swaps or ADN handshake, see drvHy8413Sam.c */
+  struct
+  {
+    epicsThreadId    tid;           /* watcher task, NULL=not averaging     */
+    unsigned short   sam;           /* SAM mode, else ADN handshake         */
+    double           poll;          /* BUF or ADN bit poll period (sec)     */
+    unsigned short   buf;           /* last BUF bit seen                    */
+    unsigned long    nswap;         /* buffer swaps or averages seen        */
+    unsigned long    nredo;         /* snapshots retaken after a swap       */
+    unsigned long    novr;          /* swaps missed, poll too slow (est.)   */
+    epicsTimeStamp   swap;          /* time the last swap was seen          */
+    double           tave;          /* nominal averaging time (sec)         */
+    double           tcycle;        /* time between the first and last ack  */
+    epicsTimeStamp   ack;           /* time of the last ADN acknowledge     */
+  } sam_s;
+
+  /* Software filters fed by the averager watcher */
+  hytec_ipmFilt_ts        filt_as[MAX_CHAN];
+
+  /* Drift correction from the on-board references, see drvHy8413Drift.c */
+  struct
+  {
+    epicsThreadId    tid;           /* drift task, NULL=never enabled       */
+    volatile unsigned short shft;   /* ema weight 2^-shft, 0=off            */
+    unsigned short   range;         /* range of the baseline                */
+    unsigned short   format;        /* format of the baseline               */
+    unsigned long    n;             /* reference samples since reset        */
+    double           r0;            /* filtered references, offset binary   */
+    double           r25;
+    double           b0;            /* baseline references                  */
+    double           b25;
+    double           gain;          /* last gain and offset computed        */
+    double           off;
+    unsigned long    nskip;         /* trims out of bounds, not applied     */
+    unsigned long    nhold;         /* trims within the deadband            */
+  } drift_s;
+
   /* Module specific functions */
   struct 
   {
@@ -307,7 +586,8 @@ typedef enum
   SetACR        = 7,
   SetIO         = 8,
   SetID         = 9,
-  SetCAL        = 10
+  SetCAL        = 10,
+  SetDATA       = 11
 } hytec_func_te;
 
 #define REG_IO_CSR  "CSR"
@@ -327,6 +607,8 @@ typedef struct hytec_devicePvt_s
   unsigned short       recType; /* type of record               */
   hytec_func_te        func;    /* type of operation            */
   hytec_ipmStatus_te   status;  /* status of operation          */
+  unsigned long        gen;     /* capture/snapshot generation  */
+  hytec_ipmCalEgu_ts  *egu_ps;  /* direct EGU conversion, or NULL */
 } hytec_devicePvt_ts;
 
 typedef struct hytec_devicePvt_s          * DPVT_ID;
@@ -89,4 +89,18 @@ long hytec_ipmCalEnb(
           unsigned short     enb     /* enable flag. 0=disable,1=enable    */
                   );
 
+/*
+ * Register a card for hytec_ipmIsr(). Returns the parameter
+ * to give ipmIntConnect(), or -1 if too many cards.
+ */
+int hytec_ipmIsrParam( void * const card_p );
+
+/*
+ * Interrupt service routine connected for all Hytec modules.
+ * The parameter is the card index from hytec_ipmIsrParam()
+ * and the module specific isr_pf routine is called with the
+ * card configuration address.
+ */
+void hytec_ipmIsr( int param );
+
 #endif /* HYTECIPMLIB_H */
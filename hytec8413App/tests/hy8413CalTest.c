@@ -0,0 +1,82 @@
+/*
+=============================================================
+
+  Abs:  Host test of the Hytec ip-adc-8413 calibration
+
+  Name: hy8413CalTest.c
+             hy8413CalTest          - Check the calibration paths (test main)
+
+  Rem:  Every faster calibration path must give the result of
+        drvHy8413_cal_adc(), the reference calibration of the
+        driver, for every raw value. This test runs the checks
+        of the shell functions on synthetic calibration points,
+        on the host:
+
+          - drvHy8413_cal_bench(): the tables, the Q32
+            fixed-point segments, the block calibration and the
+            EGU conversion, both data formats, both ranges and
+            3 and 5-point calibration, and the largest deviation
+            of drvHy8413_cal_adc() from the ideal calibration
+          - ip8413CalFixTest(): the fixed-point segments on 256
+            synthetic calibration sets
+          - ip8413CalBlkBench(): the channel and group block
+            calibration
+
+        Each check sweeps all 65536 raw values. The timings the
+        functions print are for information only.
+
+        drvHy8413_cal_adc() must stay within HY8413_TEST_CALTOL
+        counts of the ideal calibration: the reference codes it
+        maps the points to are up to 2 counts from nominal, and
+        it truncates. The two's complement check is a known
+        failure, since the driver keeps the two's complement
+        calibration points as the offset binary points masked
+        to 15 bits, so negative raw values fall outside them.
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdlib.h>
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+#include "epicsMutex.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "drvHy8413Lib.h"
+
+/* Local Definitions */
+#define HY8413_TEST_CALTOL  3.0    /* counts from the ideal calibration */
+
+MAIN(hy8413CalTest)
+{
+  double dev_a[2];
+
+  testPlan(5);
+  testOk( drvHy8413_cal_bench( NULL, 1, dev_a ) == OK,
+          "tables, fixed point, block and EGU match drvHy8413_cal_adc()" );
+  testOk( dev_a[offset_binary] <= HY8413_TEST_CALTOL,
+          "offset binary within %.0f counts of ideal (%.1f)",
+          HY8413_TEST_CALTOL, dev_a[offset_binary] );
+  testTodoBegin( "two's complement points are masked to 15 bits" );
+  testOk( dev_a[twos_compliment] <= HY8413_TEST_CALTOL,
+          "two's complement within %.0f counts of ideal (%.1f)",
+          HY8413_TEST_CALTOL, dev_a[twos_compliment] );
+  testTodoEnd();
+  testOk( ip8413CalFixTest( NULL, 1 ) == OK,
+          "fixed point matches drvHy8413_cal_adc() on synthetic sets" );
+  testOk( ip8413CalBlkBench( NULL, 1 ) == OK,
+          "block calibration matches drvHy8413_cal_adc()" );
+  return( testDone() );
+}
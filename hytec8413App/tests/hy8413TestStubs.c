@@ -0,0 +1,64 @@
+/*
+=============================================================
+
+  Abs:  Stubs of the driver for the host tests of the
+        Hytec ip-adc-8413 calibration
+
+  Name: hy8413TestStubs.c
+             hytec_ipmGetByName     - Find a card by name (stub)
+
+  Rem:  The calibration sources, drvHy8413Cal.c and
+        drvHy8413CalBench.c, call into the rest of the driver
+        only to find a card by name from the shell functions.
+        The host tests run on synthetic calibration points, so
+        no card is ever found.
+
+  Proto: hytecIpmLib.h
+
+  Auth: 17-Oct-2026, agent            (AGENT)
+  Rev : dd-mmm-yyyy, Reviewer's Name  (USERNAME)
+
+-------------------------------------------------------------
+  Mod:
+        dd-mmm-yyyy, First Lastname (USERNAME):
+           comments
+
+=============================================================
+*/
+
+/* Header Files */
+#include <stdlib.h>
+
+#include "epicsMutex.h"
+#include "dbScan.h"
+#include "drvIpac.h"
+#include "drvHy8413.h"
+#include "hytecIpm.h"
+#include "hytecIpmLib.h"
+
+
+/*====================================================
+
+  Abs:  Find a card by name (stub)
+
+  Name: hytec_ipmGetByName
+
+  Args: name_c                          Card name
+          Type: char-string
+          Use:  char const * const
+          Acc:  read-only
+          Mech: By reference
+
+  Rem: No card is created on the host.
+
+  Side: None
+
+  Ret:  void *
+             NULL - Card not found
+
+=======================================================*/
+void * hytec_ipmGetByName( char const * const name_c )
+{
+  (void)name_c;
+  return( NULL );
+}
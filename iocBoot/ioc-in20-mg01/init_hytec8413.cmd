@@ -25,6 +25,9 @@
 #
 bspExtVerbosity=3
 debugHy8413=0
+# Optional calibration cache, read before the cards are created
+# so that the id prom calibration pages are only read once per module
+#ip8413CalCache("hy8413cal.txt")
 ip8413Create("ai0",0,0,0,0)
 ip8413Create("ai1",1,0,0,0)
 ip8413Create("ai2",2,0,0,0)